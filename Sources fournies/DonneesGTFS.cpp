@@ -4,6 +4,11 @@
 
 #include "DonneesGTFS.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(RTC_SANS_AVX2)
+#include <immintrin.h>
+#define RTC_AVX2
+#endif
+
 using namespace std;
 
 //! \brief construit un objet GTFS
@@ -40,7 +45,10 @@ vector<string> DonneesGTFS::string_to_vector(const string &s, char delim)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementLigne);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementLigne, metriques);
+    enregistrerMetriques(p_nomFichier, metriques, chrono, metriques.lignesLues);
 }
 
 
@@ -49,7 +57,12 @@ void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementStation);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    size_t avant = m_stations.size();
+    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementStation, metriques);
+    indexerCoordonneesStations();
+    enregistrerMetriques(p_nomFichier, metriques, chrono, m_stations.size() - avant);
 }
 
 //! \brief ajoute les services de la date du GTFS (m_date)
@@ -57,7 +70,11 @@ void DonneesGTFS::ajouterStations(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterServices(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementService);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    size_t avant = m_services.size();
+    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementService, metriques);
+    enregistrerMetriques(p_nomFichier, metriques, chrono, m_services.size() - avant);
 }
 
 //! \brief ajoute les voyages de la date
@@ -66,7 +83,30 @@ void DonneesGTFS::ajouterServices(const std::string &p_nomFichier)
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementVoyage);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    size_t avant = m_voyages.size();
+    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementVoyage, metriques);
+    enregistrerMetriques(p_nomFichier, metriques, chrono, m_voyages.size() - avant);
+}
+
+//! \brief reconstruit la copie en structure de tableaux des positions des stations
+//! \post m_coordonneesStations contient une entrée par station de m_stations, dans le même ordre
+void DonneesGTFS::indexerCoordonneesStations()
+{
+    m_coordonneesStations = CoordonneesStations();
+    m_coordonneesStations.ids.reserve(m_stations.size());
+    m_coordonneesStations.x.reserve(m_stations.size());
+    m_coordonneesStations.y.reserve(m_stations.size());
+    m_coordonneesStations.z.reserve(m_stations.size());
+    for (const auto &station : m_stations)
+    {
+        const Coordonnees &coords = station.second.getCoords();
+        m_coordonneesStations.ids.push_back(station.first);
+        m_coordonneesStations.x.push_back(coords.getX());
+        m_coordonneesStations.y.push_back(coords.getY());
+        m_coordonneesStations.z.push_back(coords.getZ());
+    }
 }
 
 //! \brief ajoute les arrets aux voyages présents dans le GTFS si l'heure du voyage appartient à l'intervalle de temps du GTFS
@@ -74,10 +114,14 @@ void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier)
 //! \brief De plus, on enlève les stations qui n'ont pas d'arrets dans l'intervalle de temps du GTFS
 //! \param[in] p_nomFichier: le nom du fichier contenant les arrets
 //! \post assigne m_tousLesArretsPresents à true
+//! \post m_compteursArrets indique le nombre de lignes acceptées et rejetées
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementArret);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    size_t avant = m_compteursArrets.acceptees;
+    this->traiterFichierArrets(p_nomFichier, metriques);
 
     for (auto it = m_voyages.begin(); it != m_voyages.end();){
         if(it->second.getNbArrets() == 0){
@@ -92,7 +136,9 @@ void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichie
         }
         else{it++;}
     }
+    indexerCoordonneesStations();
     m_tousLesArretsPresents = true;
+    enregistrerMetriques(p_nomFichier, metriques, chrono, m_compteursArrets.acceptees - avant);
 }
 
 //! \brief ajoute les transferts dans l'objet GTFS
@@ -103,16 +149,32 @@ void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichie
 //! \throws logic_error si tous les arrets de la date et de l'intervalle n'ont pas été ajoutés
 void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier)
 {
-    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementTransfert);
+    Chronometre chrono;
+    MetriquesFichier metriques;
+    size_t avant = m_transferts.size();
+    this->traiterFichier(p_nomFichier, &DonneesGTFS::traitementTransfert, metriques);
+    enregistrerMetriques(p_nomFichier, metriques, chrono, m_transferts.size() - avant);
+}
+
+//! \brief complète les mesures de la lecture d'un fichier et les conserve dans m_metriquesFichiers
+//! \param[in] p_nomFichier: le nom du fichier lu
+//! \param[in,out] p_metriques: les mesures (octets et lignes lus) remplies lors de la lecture
+//! \param[in] p_chrono: le chronomètre démarré avant la lecture
+//! \param[in] p_acceptees: le nombre de lignes ayant produit un objet
+void DonneesGTFS::enregistrerMetriques(const std::string &p_nomFichier, MetriquesFichier &p_metriques,
+                                       const Chronometre &p_chrono, size_t p_acceptees)
+{
+    p_metriques.fichier = p_nomFichier;
+    p_metriques.lignesAcceptees = p_acceptees;
+    p_metriques.allocations = p_chrono.allocations();
+    p_metriques.tempsMs = p_chrono.ecouleMs();
+    m_metriquesFichiers.push_back(p_metriques);
 }
 
+//! \brief convertit une heure GTFS (HH:MM:SS, le nombre d'heures pouvant dépasser 24) en objet Heure
+//! \throws logic_error si le format n'est pas respecté
 Heure DonneesGTFS::stringToHeure(const std::string &p_heureEnString){
-    vector<string> stringHeureVector = string_to_vector(p_heureEnString, ':');
-    unsigned int heure = strtoul(stringHeureVector[0].c_str(), nullptr, 10);
-    unsigned int minute = strtoul(stringHeureVector[1].c_str(), nullptr, 10);
-    unsigned int seconde = strtoul(stringHeureVector[2].c_str(), nullptr, 10);
-
-    return Heure(heure, minute, seconde);
+    return Heure::depuisGTFS(p_heureEnString.data(), p_heureEnString.data() + p_heureEnString.size());
 }
 
 unsigned int DonneesGTFS::getNbArrets() const
@@ -145,6 +207,90 @@ size_t DonneesGTFS::getNbVoyages() const
     return m_voyages.size();
 }
 
+//! \brief retourne les mesures du chargement: un élément par fichier lu, et les volumes conservés
+MetriquesDonnees DonneesGTFS::getMetriques() const
+{
+    MetriquesDonnees metriques;
+    metriques.fichiers = m_metriquesFichiers;
+    metriques.nbStations = m_stations.size();
+    metriques.nbVoyages = m_voyages.size();
+    metriques.nbArrets = m_nbArrets;
+    metriques.nbTransferts = m_transferts.size();
+    return metriques;
+}
+
+//! \brief estime la mémoire allouée dynamiquement, par partie, à partir de la capacité et de la taille des conteneurs
+//! \brief Les chaînes de caractères de tous les objets sont regroupées dans la partie "chaines"; chaque arrêt
+//! (bloc de make_shared) est compté une seule fois, avec son voyage, les stations n'en comptant que les noeuds
+MemoireUtilisee DonneesGTFS::memoireUtilisee() const
+{
+    MemoirePartie lignes, stations, services, voyages, arrets, transferts, coordonnees, chaines;
+    lignes.partie = "lignes";
+    stations.partie = "stations";
+    services.partie = "services";
+    voyages.partie = "voyages";
+    arrets.partie = "arrets";
+    transferts.partie = "transferts";
+    coordonnees.partie = "coordonnees";
+    chaines.partie = "chaines";
+
+    ajouterMemoireTable(lignes, m_lignes);
+    ajouterMemoireArbre(lignes, m_lignes_par_numero);
+    for (const auto &l : m_lignes)
+    {
+        ajouterMemoire(chaines, l.second.getNumero());
+        ajouterMemoire(chaines, l.second.getDescription());
+    }
+    for (const auto &l : m_lignes_par_numero)
+    {
+        ajouterMemoire(chaines, l.first);
+        ajouterMemoire(chaines, l.second.getNumero());
+        ajouterMemoire(chaines, l.second.getDescription());
+    }
+
+    ajouterMemoireArbre(stations, m_stations);
+    for (const auto &s : m_stations)
+    {
+        ajouterMemoire(chaines, s.second.getNom());
+        ajouterMemoire(chaines, s.second.getDescription());
+        ajouterMemoireArbre(arrets, s.second.getArrets());
+    }
+
+    ajouterMemoireTable(services, m_services);
+    for (const auto &s : m_services) ajouterMemoire(chaines, s);
+
+    ajouterMemoireArbre(voyages, m_voyages);
+    for (const auto &v : m_voyages)
+    {
+        ajouterMemoire(chaines, v.first);
+        ajouterMemoire(chaines, v.second.getId());
+        ajouterMemoire(chaines, v.second.getServiceId());
+        ajouterMemoire(chaines, v.second.getDestination());
+        ajouterMemoireArbre(arrets, v.second.getArrets());
+        for (const auto &a : v.second.getArrets())
+        {
+            arrets.octets += surcoutBlocPartage + sizeof(Arret);
+            ++arrets.allocations;
+            ajouterMemoire(chaines, a->getVoyageId());
+        }
+    }
+
+    ajouterMemoire(transferts, m_transferts);
+    ajouterMemoire(coordonnees, m_coordonneesStations.ids);
+    ajouterMemoire(coordonnees, m_coordonneesStations.x);
+    ajouterMemoire(coordonnees, m_coordonneesStations.y);
+    ajouterMemoire(coordonnees, m_coordonneesStations.z);
+
+    MemoireUtilisee memoire;
+    memoire.parties = {lignes, stations, services, voyages, arrets, transferts, coordonnees, chaines};
+    return memoire;
+}
+
+const CompteursArrets &DonneesGTFS::getCompteursArrets() const
+{
+    return m_compteursArrets;
+}
+
 void DonneesGTFS::afficherLignes() const
 {
     std::cout << "======================" << std::endl;
@@ -250,6 +396,102 @@ const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &Donnee
     return m_transferts;
 }
 
+const CoordonneesStations &DonneesGTFS::getCoordonneesStations() const
+{
+    return m_coordonneesStations;
+}
+
+//! \brief marque, pour les stations [p_debut, p_fin), celles dont la corde au carré vers o (resp. d) n'excède pas p_seuil
+static void masquesRayonScalaire(const CoordonneesStations &p_coords, size_t p_debut, size_t p_fin,
+                                 const double o[3], const double d[3], double p_seuil,
+                                 uint64_t *p_masqueOrigine, uint64_t *p_masqueDestination)
+{
+    for (size_t k = p_debut; k < p_fin; ++k)
+    {
+        double ox = p_coords.x[k] - o[0], oy = p_coords.y[k] - o[1], oz = p_coords.z[k] - o[2];
+        double dx = p_coords.x[k] - d[0], dy = p_coords.y[k] - d[1], dz = p_coords.z[k] - d[2];
+        uint64_t bit = uint64_t(1) << (k % 64);
+        if (ox * ox + oy * oy + oz * oz <= p_seuil) p_masqueOrigine[k / 64] |= bit;
+        if (dx * dx + dy * dy + dz * dz <= p_seuil) p_masqueDestination[k / 64] |= bit;
+    }
+}
+
+#ifdef RTC_AVX2
+//! \brief version AVX2 de masquesRayonScalaire(), pour les blocs complets de 64 stations de [0, p_nbMots * 64):
+//! \brief quatre stations par itération, les deux points traités dans la même passe sur les positions
+__attribute__((target("avx2")))
+static void masquesRayonAVX2(const CoordonneesStations &p_coords, size_t p_nbMots,
+                             const double o[3], const double d[3], double p_seuil,
+                             uint64_t *p_masqueOrigine, uint64_t *p_masqueDestination)
+{
+    const __m256d ox = _mm256_set1_pd(o[0]), oy = _mm256_set1_pd(o[1]), oz = _mm256_set1_pd(o[2]);
+    const __m256d dx = _mm256_set1_pd(d[0]), dy = _mm256_set1_pd(d[1]), dz = _mm256_set1_pd(d[2]);
+    const __m256d seuil = _mm256_set1_pd(p_seuil);
+    for (size_t mot = 0; mot < p_nbMots; ++mot)
+    {
+        uint64_t masqueOrigine = 0;
+        uint64_t masqueDestination = 0;
+        for (unsigned int j = 0; j < 16; ++j)
+        {
+            size_t k = mot * 64 + 4 * j;
+            __m256d x = _mm256_loadu_pd(&p_coords.x[k]);
+            __m256d y = _mm256_loadu_pd(&p_coords.y[k]);
+            __m256d z = _mm256_loadu_pd(&p_coords.z[k]);
+            __m256d ex = _mm256_sub_pd(x, ox), ey = _mm256_sub_pd(y, oy), ez = _mm256_sub_pd(z, oz);
+            __m256d c2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey)), _mm256_mul_pd(ez, ez));
+            masqueOrigine |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(c2, seuil, _CMP_LE_OQ)) << (4 * j);
+            ex = _mm256_sub_pd(x, dx);
+            ey = _mm256_sub_pd(y, dy);
+            ez = _mm256_sub_pd(z, dz);
+            c2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey)), _mm256_mul_pd(ez, ez));
+            masqueDestination |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(c2, seuil, _CMP_LE_OQ)) << (4 * j);
+        }
+        p_masqueOrigine[mot] = masqueOrigine;
+        p_masqueDestination[mot] = masqueDestination;
+    }
+}
+#endif
+
+//! \brief détermine en une seule passe les stations à distance de marche du point origine et du point destination
+//! \brief Une distance d sur le grand cercle correspond à une corde c = 2 sin(d / 2R) entre vecteurs unitaires; le test
+//! \brief se fait donc sur la corde au carré, sans fonction trigonométrique. Avec AVX2 (détecté à l'exécution), quatre
+//! \brief stations sont comparées aux deux points par itération; sinon, ou si RTC_SANS_AVX2 est défini, une boucle scalaire
+//! \brief donne le même résultat. Le seuil est relevé de 1e-12 (relatif) pour qu'aucune station à distance <= p_rayon ne
+//! \brief soit perdue par arrondi: une station marquée peut être à la frontière, sa distance exacte doit être vérifiée.
+//! \param[in] p_origine: le point origine
+//! \param[in] p_destination: le point destination
+//! \param[in] p_rayon: la distance maximale, en km
+//! \param[out] p_masqueOrigine: le bit k % 64 du mot k / 64 vaut 1 ssi la station getCoordonneesStations().ids[k] est à
+//! au plus p_rayon de p_origine
+//! \param[out] p_masqueDestination: idem pour p_destination
+void DonneesGTFS::stationsDansRayon(const Coordonnees &p_origine, const Coordonnees &p_destination, double p_rayon,
+                                    std::vector<uint64_t> &p_masqueOrigine,
+                                    std::vector<uint64_t> &p_masqueDestination) const
+{
+    size_t n = m_coordonneesStations.ids.size();
+    size_t nbMots = (n + 63) / 64;
+    p_masqueOrigine.assign(nbMots, 0);
+    p_masqueDestination.assign(nbMots, 0);
+
+    double demiAngle = std::min(std::max(p_rayon, 0.0) / (2 * Coordonnees::rayonTerre), 3.14159265358979323846 / 2);
+    double corde = 2 * std::sin(demiAngle);
+    double seuil = corde * corde * (1 + 1e-12);
+    const double o[3] = {p_origine.getX(), p_origine.getY(), p_origine.getZ()};
+    const double d[3] = {p_destination.getX(), p_destination.getY(), p_destination.getZ()};
+
+    size_t debutScalaire = 0;
+#ifdef RTC_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+    {
+        masquesRayonAVX2(m_coordonneesStations, n / 64, o, d, seuil, p_masqueOrigine.data(), p_masqueDestination.data());
+        debutScalaire = n / 64 * 64;
+    }
+#endif
+    masquesRayonScalaire(m_coordonneesStations, debutScalaire, n, o, d, seuil,
+                         p_masqueOrigine.data(), p_masqueDestination.data());
+}
+
 Heure DonneesGTFS::getTempsFin() const
 {
     return m_now2;
@@ -314,14 +556,7 @@ void DonneesGTFS::traitementService(const std::vector<std::string> &vecteurStrin
     std::string exception_type = vecteurString.at(2);
 
     Date dateActuelle = this->m_date;
-    std::string strAn = dateLigneStr.substr(0,4).c_str();
-    unsigned int an = std::stoul(strAn, nullptr, 10);
-    std::string strMois = dateLigneStr.substr(4,2);
-    unsigned int mois = std::stoul(strMois, nullptr, 10);
-    std::string strJour = dateLigneStr.substr(6,2);
-    unsigned int jour = std::stoul(strJour, nullptr, 10);
-
-    Date dateLigne = Date(an, mois, jour);
+    Date dateLigne = Date::depuisGTFS(dateLigneStr.data(), dateLigneStr.data() + dateLigneStr.size());
     if(dateLigne == dateActuelle && exception_type.compare("1") == 0){
         this->m_services.insert(service_id);
     }
@@ -339,29 +574,74 @@ void DonneesGTFS::traitementVoyage(const std::vector<std::string> &vecteurString
     }
 }
 
-void DonneesGTFS::traitementArret(const std::vector<std::string> &vecteurString) {
+//! \brief lit stop_times.txt en filtrant chaque ligne directement à partir de ses caractères
+//! \brief Le trip_id est cherché dans m_voyages avant toute conversion; les heures ne sont converties que pour les
+//! \brief voyages de la date, et l'objet Arret n'est construit que pour les lignes acceptées.
+//! \brief Les champs utilisés sont trip_id (0), arrival_time (1), departure_time (2), stop_id (3) et stop_sequence (4)
+//! \param[in] p_nomFichier: le nom du fichier contenant les arrets
+//! \param[out] p_metriques: reçoit le nombre d'octets et de lignes lus
+//! \throws logic_error si un problème survient avec la lecture du fichier ou si une ligne a moins de 5 champs
+void DonneesGTFS::traiterFichierArrets(const std::string &p_nomFichier, MetriquesFichier &p_metriques)
+{
+    ifstream fichierAOuvrir(p_nomFichier);
+    if (!fichierAOuvrir.is_open()) {
+        throw std::logic_error("Erreur lors de l'ouverture du fichier.");
+    }
+    //tampons réutilisés d'une ligne à l'autre pour éviter les allocations
+    string ligneDeFichier;
+    string trip_id;
+    const char *debutChamp[5];
+    const char *finChamp[5];
 
-    std::string stop_id = vecteurString.at(3);
-    std::string arrival_time = vecteurString.at(1);
-    std::string departure_time = vecteurString.at(2);
-    std::string stop_sequence = vecteurString.at(4);
-    std::string trip_id = vecteurString.at(0);
+    //Passer la premiere ligne
+    getline(fichierAOuvrir, ligneDeFichier);
+    p_metriques.octetsLus += ligneDeFichier.size() + (fichierAOuvrir.eof() ? 0 : 1);
 
-    unsigned int stopId = strtoul(stop_id.c_str(), nullptr, 10);
-    Heure heureArriveeAutobus = stringToHeure(arrival_time);
-    Heure heureDepartAutobus = stringToHeure(departure_time);
-    unsigned int sequence = strtoul(stop_sequence.c_str(), nullptr, 10);
+    while (getline(fichierAOuvrir, ligneDeFichier)) {
+        p_metriques.octetsLus += ligneDeFichier.size() + (fichierAOuvrir.eof() ? 0 : 1);
+        if (ligneDeFichier.find('"') != string::npos) {
+            ligneDeFichier.erase(std::remove(ligneDeFichier.begin(), ligneDeFichier.end(), '\"'), ligneDeFichier.end());
+        }
+        //Arrette si la ligne ne contient pas de valeur
+        if (ligneDeFichier.empty()) break;
+        ++p_metriques.lignesLues;
+
+        const char *c = ligneDeFichier.data();
+        const char *fin = c + ligneDeFichier.size();
+        for (int champ = 0; champ < 5; ++champ) {
+            if (c > fin) throw logic_error("DonneesGTFS::traiterFichierArrets(): ligne incomplète");
+            debutChamp[champ] = c;
+            while (c < fin && *c != ',') ++c;
+            finChamp[champ] = c;
+            ++c;
+        }
 
-    Arret::Ptr a_ptr = make_shared<Arret>(stopId, heureArriveeAutobus, heureDepartAutobus, sequence, trip_id);
+        trip_id.assign(debutChamp[0], finChamp[0]);
+        auto voyage = m_voyages.find(trip_id);
+        if (voyage == m_voyages.end()) {
+            ++m_compteursArrets.rejeteesVoyage;
+            continue;
+        }
+
+        Heure heureArriveeAutobus = Heure::depuisGTFS(debutChamp[1], finChamp[1]);
+        Heure heureDepartAutobus = Heure::depuisGTFS(debutChamp[2], finChamp[2]);
+        if (heureDepartAutobus < this->m_now1 || heureArriveeAutobus >= this->m_now2) {
+            ++m_compteursArrets.rejeteesIntervalle;
+            continue;
+        }
 
-    if(heureDepartAutobus >= this->m_now1 && heureArriveeAutobus<this->m_now2 && m_voyages.find(trip_id) != m_voyages.end()){
-        m_voyages[trip_id].ajouterArret(a_ptr);
+        unsigned int stopId = strtoul(debutChamp[3], nullptr, 10);
+        unsigned int sequence = strtoul(debutChamp[4], nullptr, 10);
+        Arret::Ptr a_ptr = make_shared<Arret>(stopId, heureArriveeAutobus, heureDepartAutobus, sequence, trip_id);
+        voyage->second.ajouterArret(a_ptr);
         m_stations[stopId].addArret(a_ptr);
         m_nbArrets++;
+        ++m_compteursArrets.acceptees;
     }
 }
 
-void DonneesGTFS::traiterFichier(const std::string &p_nomFichier, void (DonneesGTFS::*functionPointer)(const std::vector<std::string> &))
+void DonneesGTFS::traiterFichier(const std::string &p_nomFichier, void (DonneesGTFS::*functionPointer)(const std::vector<std::string> &),
+                                 MetriquesFichier &p_metriques)
 {
     std::vector<std::vector<std::string>> fichierTraite;
     ifstream fichierAOuvrir;
@@ -374,9 +654,11 @@ void DonneesGTFS::traiterFichier(const std::string &p_nomFichier, void (DonneesG
     }
     //Passer la premiere ligne
     getline(fichierAOuvrir, ligneDeFichier);
+    p_metriques.octetsLus += ligneDeFichier.size() + (fichierAOuvrir.eof() ? 0 : 1);
 
     while (!fichierAOuvrir.eof()) {
         getline(fichierAOuvrir, ligneDeFichier);
+        p_metriques.octetsLus += ligneDeFichier.size() + (fichierAOuvrir.eof() ? 0 : 1);
 
         ligneDeFichier.erase(std::remove(ligneDeFichier.begin(), ligneDeFichier.end(), '\"'), ligneDeFichier.end());
 
@@ -384,6 +666,7 @@ void DonneesGTFS::traiterFichier(const std::string &p_nomFichier, void (DonneesG
 
         //Arrette si la ligne ne contient pas de valeur
         if (vecteurLigneSeparee.empty()) break;
+        ++p_metriques.lignesLues;
 
         (this->*functionPointer)(vecteurLigneSeparee);
 
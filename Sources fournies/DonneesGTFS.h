@@ -20,6 +20,25 @@
 #include "voyage.h"
 #include "arret.h"
 #include "coordonnees.h"
+#include "metriques.h"
+
+//! \brief compteurs des lignes de stop_times.txt traitées par DonneesGTFS::ajouterArretsDesVoyagesDeLaDate()
+struct CompteursArrets
+{
+    size_t acceptees = 0; //lignes ayant produit un arrêt
+    size_t rejeteesVoyage = 0; //lignes dont le voyage (trip_id) n'est pas un voyage de la date
+    size_t rejeteesIntervalle = 0; //lignes dont l'arrêt n'est pas dans l'intervalle [m_now1, m_now2)
+};
+
+//! \brief copie en structure de tableaux des positions des stations, dans l'ordre de DonneesGTFS::getStations()
+//! \brief (x[k], y[k], z[k]) est le vecteur unitaire (voir Coordonnees) de la station ids[k]
+struct CoordonneesStations
+{
+    std::vector<unsigned int> ids;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+};
 
 class DonneesGTFS
 {
@@ -48,14 +67,21 @@ public:
     size_t getNbServices() const;
     size_t getNbVoyages() const;
     size_t getNbTransferts() const;
+    const CompteursArrets & getCompteursArrets() const;
+    MetriquesDonnees getMetriques() const;
+    MemoireUtilisee memoireUtilisee() const;
     const std::map<std::string, Voyage> & getVoyages() const;
     const std::map<unsigned int, Station> & getStations() const;
     const std::unordered_map<unsigned int, Ligne> & getLignes() const;
     const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > & getTransferts() const;
+    const CoordonneesStations & getCoordonneesStations() const;
+    void stationsDansRayon(const Coordonnees &, const Coordonnees &, double,
+                           std::vector<uint64_t> &, std::vector<uint64_t> &) const;
 
-private:
+    static std::vector<std::string> string_to_vector(const std::string &s, char delim);
+    static Heure stringToHeure(const std::string &p_heureEnString);
 
-    std::vector<std::string> string_to_vector(const std::string &s, char delim);
+private:
 
     Date m_date; //la date d'intérêt
     Heure m_now1;  //l'heure de début d'intérêt (à partir de laquelle on considère les arrêts)
@@ -70,16 +96,20 @@ private:
     std::map<std::string, Voyage> m_voyages; //le string est l'identifiant (trip_id) de l'objet Voyage
     std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > m_transferts; // <from_station_id, to_station_id, min_transfer_time>
     std::multimap<std::string, Ligne> m_lignes_par_numero; //le string est l'attribut m_numero de l'objet ligne
+    CompteursArrets m_compteursArrets; //lignes de stop_times.txt acceptées et rejetées
+    CoordonneesStations m_coordonneesStations; //positions des stations de m_stations, pour le filtrage en lot par rayon
+    std::vector<MetriquesFichier> m_metriquesFichiers; //mesures de la lecture de chaque fichier, dans l'ordre de lecture
 
-    void traiterFichier(const std::string &, void (DonneesGTFS::*functionPointer)(const std::vector<std::string> &)); //parse un fichier txt et retourne un tableau de vecteurs de string, input = nom du fichier
+    void traiterFichier(const std::string &, void (DonneesGTFS::*functionPointer)(const std::vector<std::string> &),
+                        MetriquesFichier &); //parse un fichier txt et retourne un tableau de vecteurs de string, input = nom du fichier
     void traitementLigne(const std::vector<std::string> &); //
     void traitementStation(const std::vector<std::string> &); //
     void traitementTransfert(const std::vector<std::string> &); //
     void traitementService(const std::vector<std::string> &); //
     void traitementVoyage(const std::vector<std::string> &); //
-    void traitementArret(const std::vector<std::string> &); //
-
-    Heure stringToHeure(const std::string &p_heureEnString);
+    void traiterFichierArrets(const std::string &, MetriquesFichier &); //filtre les lignes de stop_times.txt avant de construire les arrêts
+    void enregistrerMetriques(const std::string &, MetriquesFichier &, const Chronometre &, size_t); //complète et conserve les mesures d'un fichier
+    void indexerCoordonneesStations(); //reconstruit m_coordonneesStations à partir de m_stations
 };
 
 #endif //TP1_GTFS_H
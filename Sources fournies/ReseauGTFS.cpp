@@ -3,10 +3,22 @@
 //
 
 #include "ReseauGTFS.h"
+#include "parallele.h"
+#include "cacheItineraires.h"
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <sstream>
 #include <sys/time.h>
 
 using namespace std;
 
+//identifiant du prochain réseau construit (0 est réservé: aucun réseau)
+static atomic<uint64_t> prochainIdentifiant(1);
+
+constexpr unsigned int ReseauGTFS::stationIdOrigine;
+constexpr unsigned int ReseauGTFS::stationIdDestination;
+
 //détermine le temps d'exécution (en microseconde) entre tv2 et tv2
 long tempsExecution(const timeval &tv1, const timeval &tv2)
 {
@@ -33,99 +45,436 @@ size_t ReseauGTFS::getNbArcs() const
     return m_leGraphe.getNbArcs();
 }
 
-double ReseauGTFS::getDistMaxMarche() const
+size_t ReseauGTFS::getNbSommets() const
+{
+    return m_leGraphe.getNbSommets();
+}
+
+size_t ReseauGTFS::getNbArcsTransferts() const
+{
+    return m_nbArcsTransferts;
+}
+
+size_t ReseauGTFS::getNbTransfertsMarche() const
+{
+    return m_nbTransfertsMarche;
+}
+
+ModeleTransferts ReseauGTFS::getModele() const
+{
+    return m_options.modele;
+}
+
+//! \brief retourne les mesures de la construction du réseau (temps et arcs ajoutés par étape, arcs par catégorie)
+const MetriquesReseau &ReseauGTFS::getMetriques() const
+{
+    return m_metriques;
+}
+
+//! \brief estime la mémoire allouée dynamiquement par le réseau, par partie, à partir de la capacité des conteneurs
+//! \brief Les arrêts pointés par m_arretDuSommet appartiennent à DonneesGTFS: seuls les pointeurs sont comptés ici
+MemoireUtilisee ReseauGTFS::memoireUtilisee() const
+{
+    MemoirePartie arretDuSommet, sommetDeArret, indexSommets, departs, transferts;
+    arretDuSommet.partie = "arretDuSommet";
+    sommetDeArret.partie = "sommetDeArret";
+    indexSommets.partie = "indexSommets";
+    departs.partie = "departsParStation";
+    transferts.partie = "transferts";
+
+    ajouterMemoire(arretDuSommet, m_arretDuSommet);
+    ajouterMemoireTable(sommetDeArret, m_sommetDeArret);
+    ajouterMemoire(indexSommets, m_stationDuSommet);
+    ajouterMemoire(indexSommets, m_ligneDuSommet);
+    ajouterMemoire(indexSommets, m_voyageDuSommet);
+    ajouterMemoire(indexSommets, m_requete.stationsOrigine);
+    ajouterMemoire(indexSommets, m_requete.stationsDestination);
+    ajouterMemoire(indexSommets, m_requete.arcs.depuisOrigine);
+    ajouterMemoire(indexSommets, m_requete.arcs.versDestination);
+    ajouterMemoire(departs, m_departsParStation);
+    for (const auto &d : m_departsParStation)
+    {
+        ajouterMemoire(departs, d.sommets);
+        ajouterMemoire(departs, d.heures);
+        ajouterMemoire(departs, d.lignes);
+        for (const auto &l : d.lignes)
+        {
+            ajouterMemoire(departs, l.heures);
+            ajouterMemoire(departs, l.positions);
+        }
+    }
+    ajouterMemoire(transferts, m_transferts);
+
+    MemoireUtilisee memoire;
+    memoire.parties = {m_leGraphe.memoireUtilisee(), arretDuSommet, sommetDeArret, indexSommets, departs,
+                       m_grapheStations.memoireUtilisee(), m_transfertsPietons.memoireUtilisee(), transferts};
+    return memoire;
+}
+
+const GrapheStations &ReseauGTFS::getGrapheStations() const
+{
+    return m_grapheStations;
+}
+
+const TransfertsPietons &ReseauGTFS::getTransfertsPietons() const
 {
-    return distanceMaxMarche;
+    return m_transfertsPietons;
+}
+
+//! \brief retourne l'identifiant du réseau, unique parmi les réseaux construits par le programme
+uint64_t ReseauGTFS::getIdentifiant() const
+{
+    return m_identifiant;
 }
 
 //! \brief construit le réseau GTFS à partir des données GTFS
 //! \param[in] Un objet DonneesGTFS
+//! \param[in] p_options: les options de construction
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post initialise la variable m_origine_dest_ajoute à false car les points origine et destination ne font pas parti du graphe
 //! \post insère les données requises dans m_arretDuSommet et m_sommetDeArret et construit le graphe m_leGraphe
-ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
-        : m_leGraphe(p_gtfs.getNbArrets()), m_origine_dest_ajoute(false)
+//! \post construit (en parallèle) le graphe condensé des stations m_grapheStations et m_stationDuSommet
+//! \post si p_options.raccourcisPietons, contracte le réseau piétonnier et ajoute ses raccourcis aux transferts
+//! \post avec ModeleTransferts::CHAINES_ATTENTE, ajoute un sommet d'attente par arrêt (voir ajouterArcsAttente())
+//! \post si p_options.rayonMarcheStations > 0, les transferts du GTFS sont complétés par des transferts à pied entre
+//! stations voisines (voir genererTransfertsMarche())
+//! \post chaque étape est répartie sur p_options.nbThreads fils d'exécution; le graphe obtenu ne dépend pas de ce nombre
+//! \post m_metriques contient le temps, les allocations et le nombre d'arcs ajoutés de chaque étape (voir getMetriques())
+ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs, const OptionsReseau &p_options)
+        : m_identifiant(prochainIdentifiant.fetch_add(1)), m_options(p_options), m_leGraphe(p_gtfs.getNbArrets()), m_nbTransfertsMarche(0), m_nbArcsTransferts(0),
+          m_origine_dest_ajoute(false)
 {
+    Chronometre chronoTotal;
+    //exécute une étape de la construction et en conserve les mesures dans m_metriques
+    auto mesurer = [this](const char *p_etape, const function<void()> &p_fonction)
+    {
+        Chronometre chrono;
+        size_t arcsAvant = m_leGraphe.getNbArcs();
+        p_fonction();
+        MetriquesEtape etape;
+        etape.etape = p_etape;
+        etape.arcsAjoutes = m_leGraphe.getNbArcs() - arcsAvant;
+        etape.allocations = chrono.allocations();
+        etape.tempsMs = chrono.ecouleMs();
+        m_metriques.etapes.push_back(etape);
+        return etape.arcsAjoutes;
+    };
+
+    vector<TransfertsPietons::Transfert> transferts = p_gtfs.getTransferts();
+    if (m_options.rayonMarcheStations > 0)
+        mesurer("transfertsMarche", [&]() { genererTransfertsMarche(p_gtfs, transferts); });
+    mesurer("reseauPietonnier", [&]()
+    {
+        //sans raccourcis, seuls les temps des transferts directs sont consultés (étapes à pied d'un itinéraire)
+        m_transfertsPietons = TransfertsPietons(transferts, m_options.tempsMaxRaccourci, m_options.nbThreads,
+                                                m_options.raccourcisPietons);
+        m_transferts = m_options.raccourcisPietons ? m_transfertsPietons.getTransferts() : transferts;
+    });
+    mesurer("grapheStations", [&]() { m_grapheStations = GrapheStations(p_gtfs, m_transferts, m_options.nbThreads); });
+
     //Le graphe possède p_gtfs.getNbArrets() sommets, mais il n'a pas encore d'arcs
-    ajouterArcsVoyages(p_gtfs);
-    ajouterArcsTransferts(p_gtfs);
+    m_metriques.arcsVoyages = mesurer("arcsVoyages", [&]() { ajouterArcsVoyages(p_gtfs); });
+    mesurer("departs", [&]() { construireDeparts(p_gtfs); });
+    if (m_options.modele == ModeleTransferts::CHAINES_ATTENTE)
+    {
+        m_metriques.arcsAttente = mesurer("arcsAttente", [&]() { ajouterArcsAttente(); });
+        m_metriques.arcsTransferts = mesurer("arcsTransferts", [&]() { ajouterArcsTransfertsAttente(p_gtfs); });
+    }
+    else
+    {
+        m_metriques.arcsTransferts = mesurer("arcsTransferts", [&]() { ajouterArcsTransferts(p_gtfs); });
+    }
+    m_nbArcsTransferts = m_metriques.arcsAttente + m_metriques.arcsTransferts;
+
+    m_metriques.nbSommets = m_leGraphe.getNbSommets();
+    m_metriques.nbArcs = m_leGraphe.getNbArcs();
+    m_metriques.transfertsMarche = m_nbTransfertsMarche;
+    m_metriques.raccourcisPietons = m_transfertsPietons.getNbRaccourcis();
+    m_metriques.arcsStations = m_grapheStations.getNbArcs();
+    m_metriques.tempsMs = chronoTotal.ecouleMs();
+}
+
+//! \brief génère un transfert à pied entre chaque paire de stations distantes d'au plus m_options.rayonMarcheStations
+//! \brief Les voisins de chaque station sont obtenus d'une GrilleStations; les stations sont réparties en blocs entre
+//! \brief les fils d'exécution et les blocs sont concaténés dans l'ordre, le résultat ne dépend donc pas de leur nombre.
+//! \brief Le temps d'un transfert généré est le temps de marche à m_options.vitesseMarcheStations. Une paire déjà présente dans
+//! \brief p_transferts (transfers.txt) n'est pas générée: le temps donné par le GTFS est conservé.
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in,out] p_transferts: les transferts du GTFS, auxquels on ajoute les transferts générés
+//! \post m_nbTransfertsMarche est le nombre de transferts ajoutés
+void ReseauGTFS::genererTransfertsMarche(const DonneesGTFS &p_gtfs, vector<TransfertsPietons::Transfert> &p_transferts)
+{
+    const CoordonneesStations &coords = p_gtfs.getCoordonneesStations();
+    GrilleStations grille(coords, m_options.rayonMarcheStations);
+    unordered_set<uint64_t> existants;
+    existants.reserve(p_transferts.size());
+    for (const auto &t : p_transferts)
+    {
+        existants.insert(((uint64_t) get<0>(t) << 32) | get<1>(t));
+    }
+
+    size_t n = coords.ids.size();
+    unsigned int nbBlocs = nbThreadsEffectifs(m_options.nbThreads, n);
+    vector<vector<TransfertsPietons::Transfert> > generesParBloc(nbBlocs);
+    executerParBlocs(n, nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+    {
+        vector<size_t> voisins;
+        for (size_t s = p_debut; s < p_fin; ++s)
+        {
+            grille.stationsProches(coords.x[s], coords.y[s], coords.z[s], voisins);
+            const Coordonnees &position = p_gtfs.getStations().at(coords.ids[s]).getCoords();
+            for (size_t v : voisins)
+            {
+                if (v == s || existants.count(((uint64_t) coords.ids[s] << 32) | coords.ids[v])) continue;
+                double distance = position - p_gtfs.getStations().at(coords.ids[v]).getCoords();
+                if (distance > m_options.rayonMarcheStations) continue;
+                unsigned int temps = distance / m_options.vitesseMarcheStations * 3600;
+                generesParBloc[p_bloc].emplace_back(coords.ids[s], coords.ids[v], temps);
+            }
+        }
+    });
+
+    m_nbTransfertsMarche = 0;
+    for (const auto &generes : generesParBloc)
+    {
+        p_transferts.insert(p_transferts.end(), generes.begin(), generes.end());
+        m_nbTransfertsMarche += generes.size();
+    }
 }
 
 //! \brief ajout des arcs dus aux voyages
 //! \brief insère les arrêts (associés aux sommets) dans m_arretDuSommet et m_sommetDeArret
+//! \brief remplit m_stationDuSommet, m_ligneDuSommet (un indice par numéro de ligne distinct) et m_voyageDuSommet
+//! \brief Les voyages sont répartis en blocs contigus entre les fils d'exécution; les sommets d'un voyage sont connus
+//! \brief d'avance (somme préfixe du nombre d'arrêts), le résultat ne dépend donc pas du nombre de fils
 //! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
 void ReseauGTFS::ajouterArcsVoyages(const DonneesGTFS & p_gtfs)
 {
     try {
-        std::map<std::string, Voyage> voyages = p_gtfs.getVoyages();
-        unsigned int poids;
-        size_t i = 0;
+        const std::map<std::string, Voyage> &voyages = p_gtfs.getVoyages();
+        unordered_map<string, unsigned int> indiceDuNumero;
+        vector<const Voyage *> voyagesOrdonnes;
+        vector<size_t> premierSommet; //premierSommet[v] est le sommet du premier arrêt du v-ème voyage
+        vector<unsigned int> ligneDuVoyage;
+        size_t nbSommets = 0;
         for (auto &itr:voyages) {
-            auto arrets = itr.second.getArrets();
-            for (auto &itrArret:arrets) {
-                m_arretDuSommet.push_back(itrArret);
-                m_sommetDeArret.emplace(itrArret, i);
-                if (itrArret != *arrets.begin()) {
-                    poids = itrArret->getHeureArrivee() - m_arretDuSommet[i - 1]->getHeureArrivee();
-                    m_leGraphe.ajouterArc(i - 1, i, poids);
+            const string &numero = p_gtfs.getLignes().at(itr.second.getLigne()).getNumero();
+            ligneDuVoyage.push_back(indiceDuNumero.emplace(numero, (unsigned int) indiceDuNumero.size()).first->second);
+            voyagesOrdonnes.push_back(&itr.second);
+            premierSommet.push_back(nbSommets);
+            nbSommets += itr.second.getNbArrets();
+        }
+        m_arretDuSommet.resize(nbSommets);
+        m_stationDuSommet.resize(nbSommets);
+        m_ligneDuSommet.resize(nbSommets);
+        m_voyageDuSommet.resize(nbSommets);
+
+        unsigned int nbBlocs = nbThreadsEffectifs(m_options.nbThreads, voyagesOrdonnes.size());
+        vector<Graphe::TamponArcs> tampons(nbBlocs);
+        executerParBlocs(voyagesOrdonnes.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+        {
+            for (size_t v = p_debut; v < p_fin; ++v) {
+                size_t i = premierSommet[v];
+                const auto &arrets = voyagesOrdonnes[v]->getArrets();
+                for (auto &itrArret:arrets) {
+                    m_arretDuSommet[i] = itrArret;
+                    m_stationDuSommet[i] = m_grapheStations.getIndice(itrArret->getStationId());
+                    m_ligneDuSommet[i] = ligneDuVoyage[v];
+                    m_voyageDuSommet[i] = (unsigned int) v;
+                    if (itrArret != *arrets.begin()) {
+                        unsigned int poids = itrArret->getHeureArrivee() - m_arretDuSommet[i - 1]->getHeureArrivee();
+                        tampons[p_bloc].emplace_back(i - 1, i, poids);
+                    }
+                    i++;
                 }
-                i++;
             }
+        });
+        m_leGraphe.ajouterArcs(tampons);
+
+        m_sommetDeArret.reserve(nbSommets);
+        for (size_t i = 0; i < nbSommets; ++i) {
+            m_sommetDeArret.emplace(m_arretDuSommet[i], i);
         }
     }
-    catch (exception e){
+    catch (const exception &e){
         throw logic_error("ReseauGTFS::ajouterArcsVoyages(const DonneesGTFS & p_gtfs): Incohérence détectée.");
     }
 }
 
+//! \brief regroupe, pour chaque station, ses arrêts par numéro de ligne dans des tableaux triés par heure
+//! \brief L'ordre de Station::getArrets() est conservé à l'intérieur de chaque ligne, et la position de chaque arrêt
+//! \brief dans Station::getArrets() est mémorisée afin de pouvoir reproduire cet ordre
+//! \brief Chaque station est traitée indépendamment, en parallèle
+//! \pre ajouterArcsVoyages() a été exécutée
+void ReseauGTFS::construireDeparts(const DonneesGTFS & p_gtfs)
+{
+    vector<const Station *> stations;
+    for (const auto &station : p_gtfs.getStations()) stations.push_back(&station.second);
+    m_departsParStation.assign(m_grapheStations.getNbStations(), DepartsStation());
 
-//! \brief ajouts des arcs dus aux transferts entre stations
+    executerParBlocs(stations.size(), nbThreadsEffectifs(m_options.nbThreads, stations.size()),
+                     [&](unsigned int, size_t p_debut, size_t p_fin)
+    {
+        for (size_t s = p_debut; s < p_fin; ++s)
+        {
+            const Station &station = *stations[s];
+            DepartsStation &departs = m_departsParStation[m_grapheStations.getIndice(station.getId())];
+            unordered_map<unsigned int, size_t> groupeDeLigne;
+            departs.sommets.reserve(station.getNbArrets());
+            departs.heures.reserve(station.getNbArrets());
+            for (const auto &arret : station.getArrets())
+            {
+                size_t position = departs.sommets.size();
+                size_t j = m_sommetDeArret.at(arret.second);
+                departs.sommets.push_back(j);
+                departs.heures.push_back(arret.first);
+                auto res = groupeDeLigne.emplace(m_ligneDuSommet[j], departs.lignes.size());
+                if (res.second)
+                {
+                    departs.lignes.emplace_back();
+                    departs.lignes.back().ligne = m_ligneDuSommet[j];
+                }
+                DepartsLigne &groupe = departs.lignes[res.first->second];
+                groupe.heures.push_back(arret.first);
+                groupe.positions.push_back(position);
+            }
+        }
+    });
+}
+
+
+//! \brief ajouts des arcs dus aux transferts entre stations (ceux de m_transferts)
+//! \brief Pour chaque arrêt de la station de départ, on ajoute un arc vers le premier départ atteignable de chaque autre
+//! \brief ligne de la station d'arrivée; ce départ est trouvé par une recherche binaire dans les tableaux de construireDeparts().
+//! \brief Les arcs d'un même arrêt sont ajoutés dans l'ordre de Station::getArrets() de la station d'arrivée.
+//! \brief Les transferts sont répartis en blocs contigus entre les fils d'exécution, puis les tampons sont fusionnés dans l'ordre
+//! \brief Ces arcs sont marqués: chacun est une correspondance (voir ParametresRecherche)
 //! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
 void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS & p_gtfs)
 {
     try {
-        auto transferts = p_gtfs.getTransferts();
-        auto stations = p_gtfs.getStations();
-        auto voyages = p_gtfs.getVoyages();
-        for (auto &transfert:transferts) {
-            unsigned int id_station1 = std::get<0>(transfert);
-            Station station1 = stations.at(id_station1);
-            unsigned int id_station2 = std::get<1>(transfert);
-            Station station2 = stations.at(id_station2);
-            unsigned int temps_minimal = std::get<2>(transfert);
-            auto arretsStation1 = station1.getArrets();
-            auto arretsStation2 = station2.getArrets();
-            for (auto &arret1:arretsStation1) {
-                size_t i = m_sommetDeArret.at(arret1.second);
-
-                std::set<std::string> lignes_ajoutees;
-                std::string id = arret1.second->getVoyageId();
-
-                auto ligne1_id = voyages.at(id).getLigne();
-                auto ligne1 = p_gtfs.getLignes().at(ligne1_id).getNumero();
-                lignes_ajoutees.emplace(ligne1);
-                for (auto arret2 = arretsStation2.lower_bound(arret1.first); arret2 != arretsStation2.end(); ++arret2) {
-                    string id2 = arret2->second->getVoyageId();
-                    auto ligne2_id = voyages.at(id2).getLigne();
-                    auto ligne2 = p_gtfs.getLignes().at(ligne2_id).getNumero();
-                    unsigned int poids = arret2->first - arret1.first;
-                    if (temps_minimal <= poids) {
-                        auto res = lignes_ajoutees.emplace(ligne2);
-                        if (res.second) {
-                            size_t j = m_sommetDeArret.at(arret2->second);
-
-                            m_leGraphe.ajouterArc(i, j, poids);
+        const auto &stations = p_gtfs.getStations();
+        unsigned int nbBlocs = nbThreadsEffectifs(m_options.nbThreads, m_transferts.size());
+        vector<Graphe::TamponArcs> tampons(nbBlocs);
+        executerParBlocs(m_transferts.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+        {
+            vector<pair<size_t, unsigned int> > candidats; //<position dans la station d'arrivée, poids>
+            for (size_t t = p_debut; t < p_fin; ++t) {
+                const auto &transfert = m_transferts[t];
+                unsigned int id_station1 = std::get<0>(transfert);
+                const Station &station1 = stations.at(id_station1);
+                unsigned int id_station2 = std::get<1>(transfert);
+                const DepartsStation &departs2 = m_departsParStation.at(m_grapheStations.getIndice(id_station2));
+                unsigned int temps_minimal = std::get<2>(transfert);
+                for (auto &arret1:station1.getArrets()) {
+                    size_t i = m_sommetDeArret.at(arret1.second);
+                    const Heure &heure1 = arret1.first;
+                    unsigned int ligne1 = m_ligneDuSommet[i];
+
+                    candidats.clear();
+                    for (const auto &groupe : departs2.lignes) {
+                        if (groupe.ligne == ligne1) continue;
+                        auto itr = lower_bound(groupe.heures.begin(), groupe.heures.end(), temps_minimal,
+                                               [&heure1](const Heure &h, unsigned int t) { return h - heure1 < (int) t; });
+                        if (itr != groupe.heures.end()) {
+                            candidats.emplace_back(groupe.positions[itr - groupe.heures.begin()], *itr - heure1);
                         }
                     }
+                    sort(candidats.begin(), candidats.end());
+                    for (const auto &candidat : candidats) {
+                        tampons[p_bloc].emplace_back(i, departs2.sommets[candidat.first], candidat.second);
+                    }
                 }
             }
-        }
+        });
+        m_leGraphe.ajouterArcs(tampons, true);
     }
-    catch(exception e){
+    catch (const exception &e){
         throw logic_error("ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS & p_gtfs): Incohérence détectée.");
     }
 }
 
+//! \brief ajoute les chaînes d'attente (ModeleTransferts::CHAINES_ATTENTE)
+//! \brief Chaque arrêt d'une station reçoit un sommet d'attente, associé au même arrêt dans m_arretDuSommet (mais absent de
+//! \brief m_sommetDeArret). Les sommets d'attente d'une station sont chaînés par heure croissante, et chacun possède
+//! \brief un arc de poids nul vers son arrêt (l'embarquement). Attendre à une station ne coûte ainsi qu'un arc par départ.
+//! \brief Les stations sont traitées en parallèle
+//! \pre construireDeparts() a été exécutée
+void ReseauGTFS::ajouterArcsAttente()
+{
+    size_t k = m_arretDuSommet.size();
+    for (auto &departs : m_departsParStation)
+    {
+        departs.premiereAttente = k;
+        k += departs.sommets.size();
+    }
+    m_leGraphe.resize(k);
+    m_arretDuSommet.resize(k);
+    m_stationDuSommet.resize(k);
+    m_ligneDuSommet.resize(k, numeric_limits<unsigned int>::max());
+    m_voyageDuSommet.resize(k);
+
+    unsigned int nbBlocs = nbThreadsEffectifs(m_options.nbThreads, m_departsParStation.size());
+    vector<Graphe::TamponArcs> tampons(nbBlocs);
+    executerParBlocs(m_departsParStation.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+    {
+        for (size_t s = p_debut; s < p_fin; ++s)
+        {
+            const DepartsStation &departs = m_departsParStation[s];
+            for (size_t p = 0; p < departs.sommets.size(); ++p)
+            {
+                size_t j = departs.sommets[p];
+                size_t attente = departs.premiereAttente + p;
+                m_arretDuSommet[attente] = m_arretDuSommet[j];
+                m_stationDuSommet[attente] = m_stationDuSommet[j];
+                m_voyageDuSommet[attente] = m_voyageDuSommet[j];
+                tampons[p_bloc].emplace_back(attente, j, 0);
+                if (p + 1 < departs.sommets.size())
+                    tampons[p_bloc].emplace_back(attente, attente + 1, departs.heures[p + 1] - departs.heures[p]);
+            }
+        }
+    });
+    m_leGraphe.ajouterArcs(tampons);
+}
+
+//! \brief ajoute les arcs dus aux transferts entre stations (ceux de m_transferts) pour ModeleTransferts::CHAINES_ATTENTE
+//! \brief Chaque arrêt de la station de départ reçoit un seul arc, vers le sommet d'attente du premier départ atteignable
+//! \brief de la station d'arrivée; les départs suivants sont accessibles par la chaîne d'attente.
+//! \brief Les transferts sont traités en parallèle et leurs arcs sont marqués, comme dans ajouterArcsTransferts()
+//! \pre ajouterArcsAttente() a été exécutée
+//! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
+void ReseauGTFS::ajouterArcsTransfertsAttente(const DonneesGTFS & p_gtfs)
+{
+    try {
+        const auto &stations = p_gtfs.getStations();
+        unsigned int nbBlocs = nbThreadsEffectifs(m_options.nbThreads, m_transferts.size());
+        vector<Graphe::TamponArcs> tampons(nbBlocs);
+        executerParBlocs(m_transferts.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+        {
+            for (size_t t = p_debut; t < p_fin; ++t) {
+                const auto &transfert = m_transferts[t];
+                const Station &station1 = stations.at(std::get<0>(transfert));
+                const DepartsStation &departs2 = m_departsParStation.at(m_grapheStations.getIndice(std::get<1>(transfert)));
+                unsigned int temps_minimal = std::get<2>(transfert);
+                for (auto &arret1:station1.getArrets()) {
+                    const Heure &heure1 = arret1.first;
+                    auto itr = lower_bound(departs2.heures.begin(), departs2.heures.end(), temps_minimal,
+                                           [&heure1](const Heure &h, unsigned int t) { return h - heure1 < (int) t; });
+                    if (itr != departs2.heures.end()) {
+                        tampons[p_bloc].emplace_back(m_sommetDeArret.at(arret1.second),
+                                                     departs2.premiereAttente + (itr - departs2.heures.begin()),
+                                                     *itr - heure1);
+                    }
+                }
+            }
+        });
+        m_leGraphe.ajouterArcs(tampons, true);
+    }
+    catch (const exception &e){
+        throw logic_error("ReseauGTFS::ajouterArcsTransfertsAttente(const DonneesGTFS & p_gtfs): Incohérence détectée.");
+    }
+}
+
 //! \brief ajoute des arcs au réseau GTFS à partir des données GTFS
 //! \brief Il s'agit des arcs allant du point origine vers une station si celle-ci est accessible à pieds et des arcs allant d'une station vers le point destination
 //! \param[in] p_gtfs: un objet DonneesGTFS
@@ -134,11 +483,33 @@ void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS & p_gtfs)
 //! \throws logic_error si une incohérence est détecté lors de la construction du graphe
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post assigne la variable m_origine_dest_ajoute à true (car les points orignine et destination font parti du graphe)
-//! \post insère dans m_sommetsVersDestination les numéros de sommets connctés au point destination
+//! \post conserve dans m_requete les arcs ajoutés et les stations reliées aux deux points
+//! \post l'heure de départ du point origine est p_gtfs.getTempsDebut()
 void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
                                                const Coordonnees &p_pointDestination)
 {
+    ajouterArcsOrigineDestination(p_gtfs, p_pointOrigine, p_pointDestination, p_gtfs.getTempsDebut());
+}
+
+//! \brief ajoute les arcs du point origine et vers le point destination pour un départ à une heure donnée
+//! \brief Seuls les départs à partir de p_heureDepart sont reliés au point origine; le poids de ces arcs est
+//! \brief l'attente depuis p_heureDepart (voir preparerRequete())
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_heureDepart: l'heure de départ du point origine, dans [p_gtfs.getTempsDebut(), p_gtfs.getTempsFin())
+//! \param[in] p_parametres: les paramètres de la recherche, conservés pour calculerItineraire()
+//! \throws logic_error si p_heureDepart est hors de l'intervalle de temps de p_gtfs
+//! \throws logic_error si une incohérence est détecté lors de la construction du graphe
+void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                               const Coordonnees &p_pointDestination, const Heure &p_heureDepart,
+                                               const ParametresRecherche &p_parametres)
+{
+    if (p_heureDepart < p_gtfs.getTempsDebut() || p_heureDepart >= p_gtfs.getTempsFin())
+        throw logic_error("ReseauGTFS::ajouterArcsOrigineDestination(): heure de départ hors de l'intervalle des données");
     try{
+        preparerRequete(p_gtfs, p_pointOrigine, p_pointDestination, p_heureDepart, p_parametres, m_requete);
+
         Arret::Ptr arretOrigine = make_shared<Arret>(stationIdOrigine, Heure(6,0,0), Heure(6,0,0), 1, "1");
         Arret::Ptr arretDestination = make_shared<Arret>(stationIdDestination, Heure(6,0,0), Heure(6,0,0),1,"1");
         size_t i = m_arretDuSommet.size();
@@ -149,53 +520,112 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
         m_arretDuSommet.push_back(arretDestination);
         m_sommetDeArret.emplace(arretDestination, i);
         m_sommetDestination = i;
+        m_leGraphe.resize(m_arretDuSommet.size());
 
+        for(const auto &arc : m_requete.arcs.depuisOrigine){
+            m_leGraphe.ajouterArc(m_sommetOrigine, arc.first, arc.second);
+        }
+        for(const auto &arc : m_requete.arcs.versDestination){
+            m_leGraphe.ajouterArc(arc.first, m_sommetDestination, arc.second);
+        }
+        m_nbArcsOrigineVersStations = m_requete.arcs.depuisOrigine.size();
+        m_nbArcsStationsVersDestination = m_requete.arcs.versDestination.size();
+        m_origine_dest_ajoute = true;
+    }
+    catch (const exception &e){
+        throw logic_error("ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination)");
+    }
+}
 
-        m_leGraphe.resize(m_arretDuSommet.size());
-        Heure heureDepart = p_gtfs.getTempsDebut();
-        auto stations = p_gtfs.getStations();
-        auto voyages = p_gtfs.getVoyages();
+//! \brief détermine les arcs qui relient un point origine et un point destination au réseau, sans modifier le graphe
+//! \brief Le premier départ atteignable de chaque ligne d'une station est trouvé par une recherche binaire dans les
+//! \brief tableaux de construireDeparts(): le coût ne dépend pas du nombre de départs de la station
+//! \param[in] p_heureDepart: l'heure de départ du point origine
+//! \param[in] p_parametres: la vitesse et la distance maximale de marche déterminent les stations reliées et les poids
+//! \param[out] p_requete: les points, l'heure, les paramètres, les stations reliées et les arcs (voir Graphe::ArcsTemporaires)
+//! \throws logic_error si les positions des stations de p_gtfs ne sont pas indexées
+//! \throws logic_error si la vitesse de marche n'est pas positive ou si la distance maximale de marche est négative
+void ReseauGTFS::preparerRequete(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                 const Coordonnees &p_pointDestination, const Heure &p_heureDepart,
+                                 const ParametresRecherche &p_parametres, Requete &p_requete) const
+{
+    if (!(p_parametres.vitesseMarche > 0) || !(p_parametres.distanceMaxMarche >= 0))
+        throw logic_error("ReseauGTFS::preparerRequete(): vitesse ou distance maximale de marche invalide");
+    const double vitesseDeMarche = p_parametres.vitesseMarche;
+    const double distanceMaxMarche = p_parametres.distanceMaxMarche;
+    p_requete.heureDepart = p_heureDepart;
+    p_requete.parametres = p_parametres;
+    p_requete.pointOrigine = p_pointOrigine;
+    p_requete.pointDestination = p_pointDestination;
+    p_requete.stationsOrigine.clear();
+    p_requete.stationsDestination.clear();
+    p_requete.arcs.depuisOrigine.clear();
+    p_requete.arcs.versDestination.clear();
+    const Heure &heureDepart = p_heureDepart;
+    const auto &stations = p_gtfs.getStations();
 
-        m_nbArcsStationsVersDestination = 0;
-        m_nbArcsOrigineVersStations = 0;
-        for(auto &station:stations){
-            Coordonnees coord = station.second.getCoords();
-            double distanceOrigine = coord - p_pointOrigine;
-            double distanceDestination = coord - p_pointDestination;
-            auto arrets = station.second.getArrets();
-
-            set<string> lignesOrigineAjoutees;
-
-            for(auto arret = arrets.lower_bound(p_gtfs.getTempsDebut());arret != arrets.end(); ++arret){
-                size_t j = m_sommetDeArret.at(arret->second);
-                if(distanceOrigine <= distanceMaxMarche){
-                    double tempsMarcheOrigine = distanceOrigine / vitesseDeMarche * 3600;
-                    unsigned int poids = arret->first - p_gtfs.getTempsDebut();
-                    if(tempsMarcheOrigine <= poids){
-                        auto ligne_id = voyages.at(arret->second->getVoyageId()).getLigne();
-                        auto ligne = p_gtfs.getLignes().at(ligne_id).getNumero();
-                        if(lignesOrigineAjoutees.emplace(ligne).second) {
-                            m_leGraphe.ajouterArc(m_sommetOrigine, j, poids);
-                            m_nbArcsOrigineVersStations++;
-                        }
-                    }
+    //stations à distance de marche de l'un ou l'autre point, déterminées en lot (dans l'ordre de stations)
+    vector<uint64_t> masqueOrigine;
+    vector<uint64_t> masqueDestination;
+    p_gtfs.stationsDansRayon(p_pointOrigine, p_pointDestination, distanceMaxMarche, masqueOrigine, masqueDestination);
+    if(p_gtfs.getCoordonneesStations().ids.size() != stations.size())
+        throw logic_error("ReseauGTFS::preparerRequete(): positions des stations non indexées");
+
+    vector<pair<size_t, unsigned int> > candidats; //<position dans Station::getArrets(), poids>
+    size_t k = 0;
+    for(auto &station:stations){
+        uint64_t bit = uint64_t(1) << (k % 64);
+        bool procheOrigine = masqueOrigine[k / 64] & bit;
+        bool procheDestination = masqueDestination[k / 64] & bit;
+        ++k;
+        if(!procheOrigine && !procheDestination) continue;
+        const Coordonnees &coord = station.second.getCoords();
+        double distanceOrigine = procheOrigine ? coord - p_pointOrigine : distanceMaxMarche + 1;
+        double distanceDestination = procheDestination ? coord - p_pointDestination : distanceMaxMarche + 1;
+
+        size_t indiceStation = m_grapheStations.getIndice(station.first);
+        const DepartsStation &departs = m_departsParStation[indiceStation];
+        if(distanceDestination <= distanceMaxMarche && !departs.sommets.empty()){
+            unsigned int poids = distanceDestination / vitesseDeMarche * 3600;
+            p_requete.stationsDestination.emplace_back(indiceStation, poids);
+        }
+        bool attente = m_options.modele == ModeleTransferts::CHAINES_ATTENTE;
+        if(distanceOrigine <= distanceMaxMarche){
+            double tempsMarcheOrigine = distanceOrigine / vitesseDeMarche * 3600;
+            auto atteignable = [&heureDepart](const Heure &h, double t) { return h - heureDepart < t; };
+            if(attente){
+                //un seul arc, vers la chaîne d'attente du premier départ atteignable à pieds
+                auto itr = lower_bound(departs.heures.begin(), departs.heures.end(), tempsMarcheOrigine, atteignable);
+                if(itr != departs.heures.end()){
+                    p_requete.stationsOrigine.push_back(indiceStation);
+                    p_requete.arcs.depuisOrigine.emplace_back(
+                            departs.premiereAttente + (itr - departs.heures.begin()), *itr - heureDepart);
+                }
+            }
+            else{
+                //un arc vers le premier départ atteignable à pieds de chaque ligne, dans l'ordre de Station::getArrets()
+                candidats.clear();
+                for(const auto &groupe : departs.lignes){
+                    auto itr = lower_bound(groupe.heures.begin(), groupe.heures.end(), tempsMarcheOrigine, atteignable);
+                    if(itr != groupe.heures.end())
+                        candidats.emplace_back(groupe.positions[itr - groupe.heures.begin()], *itr - heureDepart);
                 }
-                if(distanceDestination <= distanceMaxMarche){
-                    auto ligne2_id = voyages.at(arret->second->getVoyageId()).getLigne();
-                    auto ligne2 = p_gtfs.getLignes().at(ligne2_id).getNumero();
-                    unsigned int poids = distanceDestination / vitesseDeMarche * 3600;
-                    m_leGraphe.ajouterArc(j, m_sommetDestination, poids);
-                    m_sommetsVersDestination.push_back(j);
-                    m_nbArcsStationsVersDestination++;
+                sort(candidats.begin(), candidats.end());
+                if(!candidats.empty()) p_requete.stationsOrigine.push_back(indiceStation);
+                for(const auto &candidat : candidats){
+                    p_requete.arcs.depuisOrigine.emplace_back(departs.sommets[candidat.first], candidat.second);
                 }
             }
+        }
 
-
+        if(distanceDestination <= distanceMaxMarche){
+            //tous les arrêts à partir de l'heure de départ mènent à la destination
+            unsigned int poids = distanceDestination / vitesseDeMarche * 3600;
+            size_t debut = lower_bound(departs.heures.begin(), departs.heures.end(), heureDepart) - departs.heures.begin();
+            for(size_t p = debut; p < departs.sommets.size(); ++p){
+                p_requete.arcs.versDestination.emplace_back(departs.sommets[p], poids);
+            }
         }
-        m_origine_dest_ajoute = true;
-    }
-    catch (exception e){
-        throw logic_error("ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination)");
     }
 }
 
@@ -204,12 +634,12 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
 //! \throws logic_error si une incohérence est détecté lors de la modification du graphe
 //! \post Enlève de ReaseauGTFS tous les arcs allant du point source vers un arrêt de station et ceux allant d'un arrêt de station vers la destination
 //! \post assigne la variable m_origine_dest_ajoute à false (les points orignine et destination sont enlevés du graphe)
-//! \post enlève les données de m_sommetsVersDestination
+//! \post vide m_requete
 void ReseauGTFS::enleverArcsOrigineDestination()
 {
     try {
-        for (size_t &j:m_sommetsVersDestination) {
-            m_leGraphe.enleverArc(j, m_sommetDestination);
+        for (const auto &arc : m_requete.arcs.versDestination) {
+            m_leGraphe.enleverArc(arc.first, m_sommetDestination);
         }
 
         size_t graphSize = m_arretDuSommet.size() - 2;
@@ -227,167 +657,484 @@ void ReseauGTFS::enleverArcsOrigineDestination()
         m_nbArcsOrigineVersStations = 0;
         m_nbArcsStationsVersDestination = 0;
 
-        m_sommetsVersDestination.clear();
+        m_requete = Requete();
 
         m_origine_dest_ajoute = false;
     }
-    catch(exception e){
+    catch (const exception &e){
         throw logic_error("ReseauGTFS::enleverArcsOrgineDestination(): Incohérence détectée.");
     }
 }
 
 
+//! \brief découpe un chemin du point origine au point destination en étapes (à pieds ou en autobus)
+//! \brief Les sommets successifs d'une même station (attente, correspondance) sont regroupés; une étape en autobus va
+//! \brief de l'embarquement à la descente d'un même voyage. Seuls m_stationDuSommet et m_voyageDuSommet sont consultés
+//! \param[in] p_chemin: un chemin non trivial du sommet origine au sommet destination
+//! \param[out] p_troncons: les étapes, dans l'ordre du chemin (la marche finale vers la destination est implicite)
+//! \throws logic_error si le chemin atteint la destination ailleurs qu'à son dernier sommet, ou l'inverse
+void ReseauGTFS::compresserChemin(const vector<size_t> &p_chemin, vector<Troncon> &p_troncons) const
+{
+    const size_t aucun = numeric_limits<size_t>::max();
+    //les sommets origine et destination n'ont ni station ni voyage; ils reçoivent des stations distinctes
+    auto station = [&](size_t p_position)
+    {
+        size_t i = p_chemin[p_position];
+        if (i < m_stationDuSommet.size()) return m_stationDuSommet[i];
+        return p_position == p_chemin.size() - 1 ? aucun : aucun - 1;
+    };
+    auto voyage = [&](size_t p_position)
+    {
+        size_t i = p_chemin[p_position];
+        return i < m_voyageDuSommet.size() ? m_voyageDuSommet[i] : numeric_limits<unsigned int>::max();
+    };
+    auto verifierFin = [&](size_t p_position, const char *p_cas)
+    {
+        if (p_position != p_chemin.size() - 1)
+            throw logic_error(string("ReseauGTFS::compresserChemin(): incohérence de fin de chemin lors d'un ") + p_cas);
+    };
+
+    p_troncons.clear();
+    size_t b = 1;
+    while (b < p_chemin.size() - 1)
+    {
+        size_t a = b++;
+        while (station(b) == station(a)) a = b++;
+        //on a changé de station
+        if (station(b) == aucun) //cas où on est arrivé à la destination
+        {
+            verifierFin(b, "changement de station");
+            break;
+        }
+        if (b == p_chemin.size() - 1)
+            throw logic_error("ReseauGTFS::compresserChemin(): on ne devrait pas être arrivé à destination");
+        if (voyage(a) != voyage(b)) //on a changé de station à pieds
+        {
+            p_troncons.push_back({TypeEtape::MARCHE, a, b});
+            continue;
+        }
+        //on a changé de station avec un voyage: allons à la dernière station de ce voyage
+        size_t embarquement = a;
+        a = b++;
+        while (voyage(b) == voyage(a)) a = b++;
+        p_troncons.push_back({TypeEtape::AUTOBUS, embarquement, a});
+        if (station(b) == aucun)
+        {
+            verifierFin(b, "changement de voyage");
+            break;
+        }
+        if (station(a) != station(b)) p_troncons.push_back({TypeEtape::MARCHE, a, b});
+    }
+}
+
 //! \brief Trouve le plus court chemin menant du point d'origine au point destination préalablement choisis
 //! \brief Permet également d'affichier l'itinéraire du voyage et retourne le temps d'exécution de l'algorithme de plus court chemin utilisé
-//! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire et false autrement
+//! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire (voir afficherItineraire()) et false autrement
 //! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \param[out] p_statistiques: nullptr, ou reçoit les compteurs de la recherche (tous nuls si le graphe des stations a
+//! suffi à conclure que la destination n'est pas atteignable)
 //! \returns le temps du trajet en secondes (= numeric_limits<unsigned_int>::max() si la destination n'est pas atteignable)
 //! \throws logic_error si un problème survient durant l'exécution de la méthode
-unsigned int ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution) const
+unsigned int ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution,
+                                    StatistiquesRecherche *p_statistiques) const
+{
+    Itineraire resultat = calculerItineraire(p_gtfs, p_tempsExecution, p_statistiques);
+    if (p_afficherItineraire) afficherItineraire(cout, p_gtfs, resultat);
+    return resultat.duree;
+}
+
+//! \brief Trouve le plus court chemin menant du point d'origine au point destination préalablement choisis, sans rien afficher
+//! \brief Les étapes sont obtenues des étapes du chemin (voir compresserChemin()): les recherches dans les conteneurs
+//! \brief de p_gtfs se limitent à une par étape
+//! \param[in] p_gtfs: l'objet DonneesGTFS à partir duquel le réseau a été construit
+//! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \param[out] p_statistiques: nullptr, ou reçoit les compteurs de la recherche (voir itineraire())
+//! \returns l'itinéraire: sa durée, ses heures de départ et d'arrivée et ses étapes, du point origine au point destination
+//! \throws logic_error si le point origine et le point destination n'ont pas été ajoutés, ou si le chemin est incohérent
+Itineraire ReseauGTFS::calculerItineraire(const DonneesGTFS &p_gtfs, long &p_tempsExecution,
+                                          StatistiquesRecherche *p_statistiques) const
 {
     if (!m_origine_dest_ajoute)
         throw logic_error(
-                "ReseauGTFS::afficherItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+                "ReseauGTFS::calculerItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+    return rechercher(p_gtfs, m_requete, false, p_tempsExecution, p_statistiques);
+}
+
+//! \brief Trouve le plus court chemin entre deux points pour un départ à une heure donnée, sans modifier le réseau
+//! \brief Les arcs du point origine et vers le point destination ne sont pas ajoutés au graphe: ils sont passés à la
+//! \brief recherche (voir Graphe::ArcsTemporaires). Plusieurs fils d'exécution peuvent donc appeler cette méthode en même
+//! \brief temps sur un même réseau, pourvu qu'aucun ne le modifie (ajouterArcsOrigineDestination(), par exemple).
+//! \param[in] p_gtfs: l'objet DonneesGTFS à partir duquel le réseau a été construit
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_heureDepart: l'heure de départ du point origine, dans [p_gtfs.getTempsDebut(), p_gtfs.getTempsFin())
+//! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \param[out] p_statistiques: nullptr, ou reçoit les compteurs de la recherche (voir itineraire())
+//! \returns le même itinéraire que ajouterArcsOrigineDestination() suivi de calculerItineraire()
+//! \throws logic_error si p_heureDepart est hors de l'intervalle de temps de p_gtfs
+//! \throws logic_error si un point origine et un point destination sont déjà ajoutés au réseau
+Itineraire ReseauGTFS::calculerItineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                          const Coordonnees &p_pointDestination, const Heure &p_heureDepart,
+                                          long &p_tempsExecution, StatistiquesRecherche *p_statistiques) const
+{
+    return calculerItineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_heureDepart, ParametresRecherche(),
+                              p_tempsExecution, p_statistiques);
+}
+
+//! \brief Trouve l'itinéraire entre deux points qui respecte des paramètres de recherche, sans modifier le réseau
+//! \brief Avec une pénalité de correspondance, l'itinéraire minimise la durée plus la pénalité de chaque correspondance;
+//! \brief la durée retournée est celle du trajet, sans les pénalités
+//! \param[in] p_parametres: la marche permise, le nombre maximal de correspondances et leur pénalité
+//! \throws logic_error dans les cas de l'autre calculerItineraire(), ou si p_parametres est invalide (voir preparerRequete())
+Itineraire ReseauGTFS::calculerItineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                          const Coordonnees &p_pointDestination, const Heure &p_heureDepart,
+                                          const ParametresRecherche &p_parametres, long &p_tempsExecution,
+                                          StatistiquesRecherche *p_statistiques) const
+{
+    if (p_heureDepart < p_gtfs.getTempsDebut() || p_heureDepart >= p_gtfs.getTempsFin())
+        throw logic_error("ReseauGTFS::calculerItineraire(): heure de départ hors de l'intervalle des données");
+    if (m_origine_dest_ajoute)
+        throw logic_error("ReseauGTFS::calculerItineraire(): un point origine et un point destination sont déjà ajoutés");
+    Requete requete;
+    preparerRequete(p_gtfs, p_pointOrigine, p_pointDestination, p_heureDepart, p_parametres, requete);
+    return rechercher(p_gtfs, requete, true, p_tempsExecution, p_statistiques);
+}
+
+//! \brief recherche du plus court chemin d'une requête et construction de son itinéraire
+//! \brief Le sommet origine suit les sommets du réseau et le sommet destination le suit, que leurs arcs soient dans le
+//! \brief graphe (ajouterArcsOrigineDestination()) ou passés à la recherche (p_arcsTemporaires)
+//! \brief Les arcs de correspondance sont les arcs marqués du graphe: p_requete.parametres en limite le nombre et en
+//! \brief pénalise le coût (voir Graphe::plusCourtChemin()); les bornes du graphe des stations restent des potentiels
+//! \brief valides puisque les pénalités ne font qu'augmenter les coûts
+//! \param[in] p_requete: la requête, préparée par preparerRequete()
+//! \param[in] p_arcsTemporaires: vrai si les arcs de p_requete ne sont pas dans le graphe
+Itineraire ReseauGTFS::rechercher(const DonneesGTFS &p_gtfs, const Requete &p_requete, bool p_arcsTemporaires,
+                                  long &p_tempsExecution, StatistiquesRecherche *p_statistiques) const
+{
+    const size_t sommetOrigine = m_stationDuSommet.size();
+    const size_t sommetDestination = sommetOrigine + 1;
+    const ParametresRecherche &parametres = p_requete.parametres;
+    ContraintesChemin contraintes;
+    contraintes.penaliteMarque = parametres.penaliteCorrespondance;
+    contraintes.maxMarques = parametres.correspondancesMax;
+    const ContraintesChemin *pContraintes = contraintes.penaliteMarque == 0 &&
+            contraintes.maxMarques == numeric_limits<unsigned int>::max() ? nullptr : &contraintes;
+    //plus court chemin, avec les arcs de p_requete dans le graphe ou passés à la recherche
+    auto plusCourtChemin = [&](vector<size_t> &p_chemin, const vector<unsigned int> *p_potentiels)
+    {
+        if (p_arcsTemporaires)
+            return m_leGraphe.plusCourtChemin(p_requete.arcs, p_chemin, p_potentiels, p_statistiques, pContraintes);
+        return m_leGraphe.plusCourtChemin(sommetOrigine, sommetDestination, p_chemin, p_potentiels, p_statistiques,
+                                          pContraintes);
+    };
 
     vector<size_t> chemin;
 
     timeval tv1;
     timeval tv2;
     if (gettimeofday(&tv1, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv1");
-    unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
-    if (gettimeofday(&tv2, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv2");
-    p_tempsExecution = tempsExecution(tv1, tv2);
-
-    if (tempsDuTrajet == numeric_limits<unsigned int>::max())
+        throw logic_error("ReseauGTFS::calculerItineraire(): gettimeofday() a échoué pour tv1");
+    unsigned int tempsDuTrajet = numeric_limits<unsigned int>::max();
+    vector<size_t> stationsCibles;
+    for (const auto &cible : p_requete.stationsDestination) stationsCibles.push_back(cible.first);
+    if (!m_options.rechercheGuidee)
     {
-        if (p_afficherItineraire)
-            cout << "La destination n'est pas atteignable de l'orignine avec cette distance maximale de marche" << endl;
-        return tempsDuTrajet;
+        tempsDuTrajet = plusCourtChemin(chemin, nullptr);
     }
-
-    if (tempsDuTrajet == 0)
+    //le graphe des stations permet de rejeter immédiatement une destination inatteignable
+    else if (m_grapheStations.estAtteignable(p_requete.stationsOrigine, stationsCibles))
     {
-        if (p_afficherItineraire) cout << "Vous êtes déjà situé à la destination demandée" << endl;
-        return tempsDuTrajet;
+        //sinon, ses distances vers la destination servent de potentiels pour guider et élaguer la recherche
+        vector<unsigned int> bornes;
+        m_grapheStations.bornesInferieures(p_requete.stationsDestination, bornes);
+        vector<unsigned int> potentiels(sommetDestination + 1, 0);
+        for (size_t i = 0; i < m_stationDuSommet.size(); ++i)
+        {
+            potentiels[i] = bornes[m_stationDuSommet[i]];
+        }
+        tempsDuTrajet = plusCourtChemin(chemin, &potentiels);
+    }
+    else
+    {
+        chemin.assign(1, sommetDestination);
+        if (p_statistiques) *p_statistiques = StatistiquesRecherche();
     }
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("ReseauGTFS::calculerItineraire(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+
+    Itineraire resultat;
+    resultat.heureDepart = p_requete.heureDepart;
+    resultat.duree = tempsDuTrajet;
+    if (tempsDuTrajet == numeric_limits<unsigned int>::max()) return resultat;
+    resultat.atteignable = true;
+    resultat.heureArrivee = p_requete.heureDepart.add_secondes(tempsDuTrajet);
+    if (tempsDuTrajet == 0) return resultat;
 
     //un chemin non trivial a été trouvé
     if (chemin.size() <= 2)
-        throw logic_error("ReseauGTFS::afficherItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
+        throw logic_error("ReseauGTFS::calculerItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
+    if (chemin.front() != sommetOrigine)
+        throw logic_error("ReseauGTFS::calculerItineraire(): le premier noeud du chemin doit être le point origine");
+    if (chemin.back() != sommetDestination)
+        throw logic_error("ReseauGTFS::calculerItineraire(): le dernier noeud du chemin doit être le point destination");
+
+    //avec une pénalité, la longueur du chemin est un coût: la durée est l'heure du dernier arrêt plus la marche finale
+    const Arret &dernier = *m_arretDuSommet[chemin[chemin.size() - 2]];
+    if (contraintes.penaliteMarque > 0)
+    {
+        size_t stationDernier = m_stationDuSommet[chemin[chemin.size() - 2]];
+        auto cible = find_if(p_requete.stationsDestination.begin(), p_requete.stationsDestination.end(),
+                             [stationDernier](const pair<size_t, unsigned int> &s) { return s.first == stationDernier; });
+        if (cible == p_requete.stationsDestination.end())
+            throw logic_error("ReseauGTFS::calculerItineraire(): le chemin ne finit pas par un arc vers le point destination");
+        resultat.duree = (unsigned int) (dernier.getHeureArrivee() - p_requete.heureDepart) + cible->second;
+        resultat.heureArrivee = p_requete.heureDepart.add_secondes(resultat.duree);
+    }
+
+    vector<Troncon> troncons;
+    compresserChemin(chemin, troncons);
+
+    //marche du point origine vers la première station (même temps que l'arc du point origine)
+    const auto &stations = p_gtfs.getStations();
+    const Arret &premier = *m_arretDuSommet[chemin[1]];
+    EtapeItineraire marche;
+    marche.type = TypeEtape::MARCHE;
+    marche.stationDepart = stationIdOrigine;
+    marche.stationArrivee = premier.getStationId();
+    marche.heureDepart = p_requete.heureDepart;
+    double tempsMarcheExact = (stations.at(premier.getStationId()).getCoords() - p_requete.pointOrigine)
+                              / parametres.vitesseMarche * 3600;
+    unsigned int tempsMarche = tempsMarcheExact;
+    marche.heureArrivee = p_requete.heureDepart.add_secondes(tempsMarche);
+    resultat.etapes.push_back(marche);
+    //l'arc du point origine inclut l'attente du premier départ: partir plus tard d'au plus cette attente ne change rien
+    const auto &arcsOrigine = p_requete.arcs.depuisOrigine;
+    auto arc = find_if(arcsOrigine.begin(), arcsOrigine.end(),
+                       [&chemin](const pair<size_t, unsigned int> &a) { return a.first == chemin[1]; });
+    if (arc == arcsOrigine.end())
+        throw logic_error("ReseauGTFS::calculerItineraire(): le chemin ne débute pas par un arc du point origine");
+    unsigned int attente = arc->second - (unsigned int) ceil(tempsMarcheExact);
+    resultat.departAuPlusTard = p_requete.heureDepart.add_secondes(attente);
 
-    if (m_arretDuSommet[chemin[0]]->getStationId() != stationIdOrigine)
+    for (const Troncon &troncon : troncons)
     {
-        cout << "m_arretDuSommet[chemin[0]]->getStationId() = " << m_arretDuSommet[chemin[0]]->getStationId() << endl;
-        cout << "chemin[0] = " << chemin[0] << " m_sommetOrigine = " << m_sommetOrigine << endl;
-        for (const auto & i : chemin)
+        const Arret &debut = *m_arretDuSommet[chemin[troncon.debut]];
+        const Arret &fin = *m_arretDuSommet[chemin[troncon.fin]];
+        EtapeItineraire etape;
+        etape.type = troncon.type;
+        etape.stationDepart = debut.getStationId();
+        etape.stationArrivee = fin.getStationId();
+        etape.heureDepart = debut.getHeureArrivee();
+        if (troncon.type == TypeEtape::MARCHE)
         {
-            cout << "chemin[" << i << "] = " << chemin[i] << endl;
+            //le temps du transfert; à défaut, l'écart entre les deux arrêts
+            unsigned int temps;
+            if (m_transfertsPietons.tempsDeMarche(debut.getStationId(), fin.getStationId(), temps))
+                etape.heureArrivee = debut.getHeureArrivee().add_secondes(temps);
+            else etape.heureArrivee = fin.getHeureArrivee();
         }
-        throw logic_error("ReseauGTFS::afficherItineraire(): le premier noeud du chemin doit être le point origine");
+        else
+        {
+            etape.heureArrivee = fin.getHeureArrivee();
+            etape.voyageId = debut.getVoyageId();
+            const Voyage &voyage = p_gtfs.getVoyages().at(etape.voyageId);
+            etape.numeroLigne = p_gtfs.getLignes().at(voyage.getLigne()).getNumero();
+        }
+        resultat.etapes.push_back(etape);
     }
-    if (m_arretDuSommet[chemin[chemin.size() - 1]]->getStationId() != stationIdDestination)
-        throw logic_error(
-                "ReseauGTFS::afficherItineraire(): le dernier noeud du chemin doit être le point destination");
 
+    //marche de la dernière station vers le point destination
+    marche.stationDepart = dernier.getStationId();
+    marche.stationArrivee = stationIdDestination;
+    marche.heureDepart = dernier.getHeureArrivee();
+    marche.heureArrivee = resultat.heureArrivee;
+    resultat.etapes.push_back(marche);
+    return resultat;
+}
 
-    if (p_afficherItineraire)
+//! \brief affiche un itinéraire: ses étapes, son heure d'arrivée et sa durée
+//! \param[in] p_flux: le flux où l'itinéraire est écrit
+//! \param[in] p_gtfs: l'objet DonneesGTFS à partir duquel l'itinéraire a été calculé (pour les stations et les voyages)
+//! \param[in] p_itineraire: un itinéraire obtenu de calculerItineraire()
+void ReseauGTFS::afficherItineraire(std::ostream &p_flux, const DonneesGTFS &p_gtfs, const Itineraire &p_itineraire)
+{
+    if (!p_itineraire.atteignable)
     {
-        std::cout << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << "     ITINÉRAIRE      " << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << std::endl;
+        p_flux << "La destination n'est pas atteignable de l'orignine avec cette distance maximale de marche" << endl;
+        return;
+    }
+    if (p_itineraire.duree == 0)
+    {
+        p_flux << "Vous êtes déjà situé à la destination demandée" << endl;
+        return;
     }
 
-    if (p_afficherItineraire) cout << "Heure de départ du point d'origine: "  << p_gtfs.getTempsDebut() << endl;
-    Arret::Ptr ptr_a = m_arretDuSommet.at(chemin[0]);
-    Arret::Ptr ptr_b = m_arretDuSommet.at(chemin[1]);
-    if (p_afficherItineraire)
-        cout << "Rendez vous à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
-
-    unsigned int sommet = 1;
+    p_flux << endl;
+    p_flux << "=====================" << endl;
+    p_flux << "     ITINÉRAIRE      " << endl;
+    p_flux << "=====================" << endl;
+    p_flux << endl;
 
-    while (sommet < chemin.size() - 1)
+    const auto &stations = p_gtfs.getStations();
+    const auto &etapes = p_itineraire.etapes;
+    p_flux << "Heure de départ du point d'origine: " << p_itineraire.heureDepart << endl;
+    p_flux << "Rendez vous à la station " << stations.at(etapes.front().stationArrivee) << endl;
+    for (size_t i = 1; i + 1 < etapes.size(); ++i)
     {
-        ptr_a = ptr_b;
-        ++sommet;
-        ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        while (ptr_b->getStationId() == ptr_a->getStationId())
+        const EtapeItineraire &etape = etapes[i];
+        if (etape.type == TypeEtape::MARCHE)
         {
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
+            p_flux << "De cette station, rendez-vous à pieds à la station " << stations.at(etape.stationArrivee) << endl;
+            continue;
         }
-        //on a changé de station
-        if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
+        p_flux << "De cette station, prenez l'autobus numéro " << etape.numeroLigne << " à l'heure " << etape.heureDepart
+               << " " << p_gtfs.getVoyages().at(etape.voyageId) << endl;
+        p_flux << "et arrêtez-vous à la station " << stations.at(etape.stationArrivee) << " à l'heure "
+               << etape.heureArrivee << endl;
+    }
+    p_flux << "Déplacez-vous à pieds de cette station au point destination" << endl;
+    p_flux << "Heure d'arrivée à la destination: " << p_itineraire.heureArrivee << endl;
+
+    unsigned int h = p_itineraire.duree / 3600;
+    unsigned int reste_sec = p_itineraire.duree % 3600;
+    unsigned int m = reste_sec / 60;
+    unsigned int s = reste_sec % 60;
+    p_flux << "Durée du trajet: " << h << " heures, " << m << " minutes, " << s << " secondes" << endl;
+}
+
+//écrit une heure au format JSON (une chaîne HH:MM:SS)
+static void ecrireHeureJSON(ostream &p_flux, const Heure &p_heure)
+{
+    ostringstream texte;
+    texte << p_heure;
+    ecrireChaineJSON(p_flux, texte.str());
+}
+
+//! \brief écrit un itinéraire au format JSON (un objet); la durée et l'arrivée sont null si la destination n'est pas atteignable
+void ecrireJSON(ostream &p_flux, const Itineraire &p_itineraire)
+{
+    p_flux << "{\"atteignable\": " << (p_itineraire.atteignable ? "true" : "false") << ", \"heureDepart\": ";
+    ecrireHeureJSON(p_flux, p_itineraire.heureDepart);
+    if (!p_itineraire.atteignable)
+    {
+        p_flux << ", \"heureArrivee\": null, \"duree\": null, \"etapes\": []}";
+        return;
+    }
+    p_flux << ", \"heureArrivee\": ";
+    ecrireHeureJSON(p_flux, p_itineraire.heureArrivee);
+    p_flux << ", \"duree\": " << p_itineraire.duree << ", \"etapes\": [";
+    for (size_t i = 0; i < p_itineraire.etapes.size(); ++i)
+    {
+        const EtapeItineraire &e = p_itineraire.etapes[i];
+        p_flux << (i ? ", " : "") << "{\"type\": " << (e.type == TypeEtape::MARCHE ? "\"marche\"" : "\"autobus\"")
+               << ", \"stationDepart\": " << e.stationDepart << ", \"stationArrivee\": " << e.stationArrivee
+               << ", \"heureDepart\": ";
+        ecrireHeureJSON(p_flux, e.heureDepart);
+        p_flux << ", \"heureArrivee\": ";
+        ecrireHeureJSON(p_flux, e.heureArrivee);
+        if (e.type == TypeEtape::AUTOBUS)
         {
-            if (sommet != chemin.size() - 1)
-                throw logic_error(
-                        "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'un changement de station");
-            break;
+            p_flux << ", \"ligne\": ";
+            ecrireChaineJSON(p_flux, e.numeroLigne);
+            p_flux << ", \"voyage\": ";
+            ecrireChaineJSON(p_flux, e.voyageId);
         }
-        if (sommet == chemin.size() - 1)
-            throw logic_error("ReseauGTFS::afficherItineraire(): on ne devrait pas être arrivé à destination");
-        //on a changé de station mais sommet n'est pas le noeud destination
-        string voyage_id_a = ptr_a->getVoyageId();
-        string voyage_id_b = ptr_b->getVoyageId();
-        if (voyage_id_a != voyage_id_b) //on a changé de station à pieds
+        p_flux << "}";
+    }
+    p_flux << "]}";
+}
+
+//! \brief détermine la clé d'une requête: les stations reliées à chaque point, avec leur temps de marche arrondi comme
+//! dans ajouterArcsOrigineDestination() (à la seconde supérieure pour l'origine, puisqu'il y est comparé à des écarts
+//! entiers), les contraintes de correspondance de p_parametres et l'intervalle de départ
+void ReseauGTFS::cleItineraire(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                               const Coordonnees &p_pointDestination, const Heure &p_heureDepart,
+                               const ParametresRecherche &p_parametres, unsigned int p_largeurIntervalle,
+                               CleItineraire &p_cle) const
+{
+    const double vitesseDeMarche = p_parametres.vitesseMarche;
+    const double distanceMaxMarche = p_parametres.distanceMaxMarche;
+    vector<uint64_t> masqueOrigine;
+    vector<uint64_t> masqueDestination;
+    p_gtfs.stationsDansRayon(p_pointOrigine, p_pointDestination, distanceMaxMarche, masqueOrigine, masqueDestination);
+    p_cle.origine.clear();
+    p_cle.destination.clear();
+    size_t k = 0;
+    for (const auto &station : p_gtfs.getStations())
+    {
+        uint64_t bit = uint64_t(1) << (k % 64);
+        const Coordonnees &coord = station.second.getCoords();
+        if (masqueOrigine[k / 64] & bit)
         {
-            if (p_afficherItineraire)
-                cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+            double distance = coord - p_pointOrigine;
+            if (distance <= distanceMaxMarche)
+                p_cle.origine.emplace_back(station.first, (unsigned int) ceil(distance / vitesseDeMarche * 3600));
         }
-        else //on a changé de station avec un voyage
+        if (masqueDestination[k / 64] & bit)
         {
-            Heure heure = ptr_a->getHeureArrivee();
-            unsigned int ligne_id = p_gtfs.getVoyages().at(voyage_id_a).getLigne();
-            string ligne_numero = p_gtfs.getLignes().at(ligne_id).getNumero();
-            if (p_afficherItineraire)
-                cout << "De cette station, prenez l'autobus numéro " << ligne_numero << " à l'heure " << heure << " "
-                     << p_gtfs.getVoyages().at(voyage_id_a) << endl;
-            //maintenant allons à la dernière station de ce voyage
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            while (ptr_b->getVoyageId() == ptr_a->getVoyageId())
-            {
-                ptr_a = ptr_b;
-                ++sommet;
-                ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            }
-            //on a changé de voyage
-            if (p_afficherItineraire)
-                cout << "et arrêtez-vous à la station " << p_gtfs.getStations().at(ptr_a->getStationId()) << " à l'heure "
-                     << ptr_a->getHeureArrivee() << endl;
-            if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
-            {
-                if (sommet != chemin.size() - 1)
-                    throw logic_error(
-                            "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'u changement de voyage");
-                break;
-            }
-            if (ptr_a->getStationId() != ptr_b->getStationId()) //alors on s'est rendu à pieds à l'autre station
-                if (p_afficherItineraire)
-                    cout << "De cette station, rendez-vous à pieds à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+            double distance = coord - p_pointDestination;
+            if (distance <= distanceMaxMarche)
+                p_cle.destination.emplace_back(station.first, (unsigned int) (distance / vitesseDeMarche * 3600));
         }
+        ++k;
     }
+    p_cle.correspondancesMax = p_parametres.correspondancesMax;
+    p_cle.penaliteCorrespondance = p_parametres.penaliteCorrespondance;
+    p_cle.intervalle = (unsigned int) (p_heureDepart - Heure(0, 0, 0)) / p_largeurIntervalle;
+}
+
+//! \brief Trouve un itinéraire entre deux points, en le cherchant d'abord dans un cache
+//! \brief Un itinéraire conservé pour la même clé est réutilisé si p_heureDepart est entre son heure de départ et son
+//! \brief heure de départ au plus tard: il prend alors les mêmes autobus et arrive à la même heure qu'une recherche
+//! \brief faite à p_heureDepart. Sinon, l'itinéraire est calculé puis conservé à la place de l'ancien.
+//! \param[in] p_gtfs: l'objet DonneesGTFS à partir duquel le réseau a été construit
+//! \param[in,out] p_cache: le cache consulté, puis mis à jour en cas d'absence
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_heureDepart: l'heure de départ du point origine
+//! \param[out] p_tempsExecution: le temps de la recherche (0 si l'itinéraire provient du cache)
+//! \throws logic_error si un point origine et un point destination sont déjà ajoutés au réseau
+Itineraire ReseauGTFS::itineraireEnCache(const DonneesGTFS &p_gtfs, CacheItineraires &p_cache,
+                                         const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination,
+                                         const Heure &p_heureDepart, long &p_tempsExecution) const
+{
+    return itineraireEnCache(p_gtfs, p_cache, p_pointOrigine, p_pointDestination, p_heureDepart, ParametresRecherche(),
+                             p_tempsExecution);
+}
 
-    if (p_afficherItineraire)
+//! \brief Trouve un itinéraire entre deux points selon des paramètres de recherche, en le cherchant d'abord dans un cache
+//! \brief Les paramètres font partie de la clé; le raisonnement de l'autre itineraireEnCache() tient toujours, car
+//! \brief retarder le départ change d'une même constante le coût de tous les itinéraires encore possibles
+//! \param[in] p_parametres: les paramètres de la recherche (voir calculerItineraire())
+Itineraire ReseauGTFS::itineraireEnCache(const DonneesGTFS &p_gtfs, CacheItineraires &p_cache,
+                                         const Coordonnees &p_pointOrigine, const Coordonnees &p_pointDestination,
+                                         const Heure &p_heureDepart, const ParametresRecherche &p_parametres,
+                                         long &p_tempsExecution) const
+{
+    CleItineraire cle;
+    cleItineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_heureDepart, p_parametres,
+                  p_cache.getLargeurIntervalle(), cle);
+    Itineraire resultat;
+    p_tempsExecution = 0;
+    if (!p_cache.chercher(m_identifiant, cle, p_heureDepart, resultat))
     {
-        cout << "Déplacez-vous à pieds de cette station au point destination" << endl;
-        cout << "Heure d'arrivée à la destination: " << p_gtfs.getTempsDebut().add_secondes(tempsDuTrajet) << endl;
+        resultat = calculerItineraire(p_gtfs, p_pointOrigine, p_pointDestination, p_heureDepart, p_parametres,
+                                      p_tempsExecution);
+        p_cache.inserer(m_identifiant, cle, resultat);
+        return resultat;
     }
-    unsigned int h = tempsDuTrajet / 3600;
-    unsigned int reste_sec = tempsDuTrajet % 3600;
-    unsigned int m = reste_sec / 60;
-    unsigned int s = reste_sec % 60;
-    if (p_afficherItineraire)
+
+    //mêmes autobus, départ retardé: seule la marche vers la première station se déplace
+    if (resultat.atteignable && resultat.duree > 0)
     {
-        cout << "Durée du trajet: " << h << " heures, " << m << " minutes, " << s << " secondes" << endl;
+        EtapeItineraire &marche = resultat.etapes.front();
+        unsigned int tempsMarche = marche.heureArrivee - marche.heureDepart;
+        marche.heureDepart = p_heureDepart;
+        marche.heureArrivee = p_heureDepart.add_secondes(tempsMarche);
+        resultat.duree = resultat.heureArrivee - p_heureDepart;
     }
-
-    return tempsDuTrajet;
+    else if (resultat.atteignable) resultat.heureArrivee = p_heureDepart;
+    resultat.heureDepart = p_heureDepart;
+    return resultat;
 }
-
-
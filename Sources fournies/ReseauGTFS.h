@@ -7,40 +7,181 @@
 
 #include "DonneesGTFS.h"
 #include "graphe.h"
+#include "grapheStations.h"
+#include "transfertsPietons.h"
+#include "grilleStations.h"
 
+//! \brief façon de représenter les transferts dans le graphe du réseau GTFS
+enum class ModeleTransferts
+{
+    TOUTES_LIGNES, //un arc vers le premier départ atteignable de chaque ligne de la station d'arrivée
+    CHAINES_ATTENTE //un arc vers le premier départ atteignable de la chaîne d'attente de la station d'arrivée
+};
+
+//! \brief options de construction du réseau GTFS
+struct OptionsReseau
+{
+    ModeleTransferts modele = ModeleTransferts::TOUTES_LIGNES;
+    bool raccourcisPietons = false; //ajoute un transfert direct entre les stations reliées par une chaîne de transferts
+    unsigned int tempsMaxRaccourci = 1200; //temps maximal, en secondes, d'un raccourci piétonnier
+    unsigned int nbThreads = 0; //nombre de fils d'exécution utilisés pour la construction (0 = nombre de coeurs)
+    double rayonMarcheStations = 0; //distance, en km, des transferts à pied générés entre stations voisines (0 = aucun)
+    double vitesseMarcheStations = 5.0; //vitesse de marche, en km/heure, qui donne le temps de ces transferts générés
+    bool rechercheGuidee = true; //itineraire() élague et guide la recherche (A*) avec le graphe des stations; sinon Dijkstra
+};
+
+//! \brief paramètres d'une recherche d'itinéraire, propres à chaque requête (voir ReseauGTFS::calculerItineraire())
+//! \brief Ils ne changent que les arcs du point origine et vers le point destination et le coût des arcs de
+//! \brief correspondance: un même réseau sert ainsi plusieurs profils d'usagers sans être reconstruit. Les transferts
+//! \brief à pied entre stations font partie du graphe et gardent le temps donné à la construction.
+struct ParametresRecherche
+{
+    double vitesseMarche = 5.0; //vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia
+    double distanceMaxMarche = 1.5; //distance maximale de marche, en km, entre un point et une station
+    unsigned int correspondancesMax = std::numeric_limits<unsigned int>::max(); //correspondances permises (sans limite)
+    unsigned int penaliteCorrespondance = 0; //secondes ajoutées au coût de chaque correspondance (pas à la durée)
+};
+
+//! \brief type d'une étape d'un itinéraire
+enum class TypeEtape {MARCHE, AUTOBUS};
+
+//! \brief une étape d'un itinéraire (voir ReseauGTFS::calculerItineraire())
+//! \brief Les heures sont celles des arrêts du GTFS (heures d'arrivée), ou le départ et l'arrivée d'une marche;
+//! \brief l'attente à une station est l'écart entre l'arrivée d'une étape et le départ de la suivante
+struct EtapeItineraire
+{
+    TypeEtape type;
+    unsigned int stationDepart; //identifiant de la station quittée (0 pour le point origine)
+    unsigned int stationArrivee; //identifiant de la station atteinte (1 pour le point destination)
+    Heure heureDepart;
+    Heure heureArrivee;
+    std::string voyageId; //le voyage emprunté (vide pour une marche)
+    std::string numeroLigne; //le numéro de ligne de ce voyage (vide pour une marche)
+};
+
+//! \brief résultat d'une recherche d'itinéraire entre le point origine et le point destination
+struct Itineraire
+{
+    bool atteignable = false; //faux si la destination n'est pas atteignable de l'origine
+    unsigned int duree = std::numeric_limits<unsigned int>::max(); //durée du trajet en secondes (max si non atteignable)
+    Heure heureDepart; //l'heure de départ du point origine
+    Heure heureArrivee; //l'heure d'arrivée au point destination (si atteignable)
+    Heure departAuPlusTard; //dernière heure de départ du point origine permettant encore de prendre les mêmes autobus
+    std::vector<EtapeItineraire> etapes; //de l'origine à la destination; vide si la durée est nulle ou non atteignable
+};
+
+void ecrireJSON(std::ostream &p_flux, const Itineraire &p_itineraire);
+
+class CacheItineraires;
+struct CleItineraire;
 
 class ReseauGTFS
 {
 
 public:
-    explicit ReseauGTFS(const DonneesGTFS &);
+    explicit ReseauGTFS(const DonneesGTFS &, const OptionsReseau & = OptionsReseau());
     void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
+    void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                                       const ParametresRecherche & = ParametresRecherche());
     void enleverArcsOrigineDestination();
-    unsigned int itineraire(const DonneesGTFS &, bool, long &) const;
+    unsigned int itineraire(const DonneesGTFS &, bool, long &, StatistiquesRecherche * = nullptr) const;
+    Itineraire calculerItineraire(const DonneesGTFS &, long &, StatistiquesRecherche * = nullptr) const;
+    Itineraire calculerItineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &, long &,
+                                  StatistiquesRecherche * = nullptr) const;
+    Itineraire calculerItineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                                  const ParametresRecherche &, long &, StatistiquesRecherche * = nullptr) const;
+    static void afficherItineraire(std::ostream &, const DonneesGTFS &, const Itineraire &);
+    Itineraire itineraireEnCache(const DonneesGTFS &, CacheItineraires &, const Coordonnees &, const Coordonnees &,
+                                 const Heure &, long &) const;
+    Itineraire itineraireEnCache(const DonneesGTFS &, CacheItineraires &, const Coordonnees &, const Coordonnees &,
+                                 const Heure &, const ParametresRecherche &, long &) const;
+    uint64_t getIdentifiant() const;
     size_t getNbArcsOrigineVersStations() const;
     size_t getNbArcsStationsVersDestination() const;
     size_t getNbArcs() const;
-    double getDistMaxMarche() const;
+    size_t getNbSommets() const;
+    size_t getNbArcsTransferts() const;
+    size_t getNbTransfertsMarche() const;
+    ModeleTransferts getModele() const;
+    const MetriquesReseau & getMetriques() const;
+    MemoireUtilisee memoireUtilisee() const;
+    const GrapheStations & getGrapheStations() const;
+    const TransfertsPietons & getTransfertsPietons() const;
+
+    static constexpr unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
+    static constexpr unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
 
 private:
+    uint64_t m_identifiant; //identifiant unique du réseau (voir CacheItineraires)
+    OptionsReseau m_options;
     Graphe m_leGraphe;
     std::vector<Arret::Ptr> m_arretDuSommet; //m_arretDuSommet[i] est le pointeur (shared_ptr) de l'arret (associé au sommet i du graphe
     std::unordered_map<Arret::Ptr,size_t> m_sommetDeArret; //m_sommetDeArret[a_ptr] est le sommet du graphe associé au pointeur de l'arret a_ptr
-    std::vector<size_t> m_sommetsVersDestination; //Chaque élément est un sommet possédant un arc vers la destination
+    TransfertsPietons m_transfertsPietons; //fermeture du réseau piétonnier (transferts directs seulement sans raccourcis)
+    std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > m_transferts; //les transferts utilisés pour construire le graphe
+    GrapheStations m_grapheStations; //graphe condensé des stations, utilisé pour élaguer la recherche
+    std::vector<size_t> m_stationDuSommet; //m_stationDuSommet[i] est le sommet, dans m_grapheStations, de la station de l'arrêt i
+    std::vector<unsigned int> m_ligneDuSommet; //m_ligneDuSommet[i] est l'indice du numéro de ligne du voyage de l'arrêt i
+    std::vector<unsigned int> m_voyageDuSommet; //m_voyageDuSommet[i] est l'indice (dans getVoyages()) du voyage de l'arrêt i
+
+    struct DepartsLigne //les arrêts d'une ligne à une station, dans l'ordre de Station::getArrets()
+    {
+        unsigned int ligne; //indice du numéro de ligne (voir m_ligneDuSommet)
+        std::vector<Heure> heures; //heures[k] est la clé du k-ème arrêt de cette ligne dans Station::getArrets()
+        std::vector<size_t> positions; //positions[k] est la position de ce k-ème arrêt dans Station::getArrets()
+    };
+    struct DepartsStation
+    {
+        std::vector<size_t> sommets; //sommets[p] est le sommet du p-ème arrêt de Station::getArrets()
+        std::vector<Heure> heures; //heures[p] est la clé du p-ème arrêt de Station::getArrets()
+        std::vector<DepartsLigne> lignes;
+        size_t premiereAttente; //avec ModeleTransferts::CHAINES_ATTENTE, le sommet d'attente de la position p est premiereAttente + p
+    };
+    std::vector<DepartsStation> m_departsParStation; //indexé par le sommet de la station dans m_grapheStations
+    size_t m_nbTransfertsMarche; //le nombre de transferts à pied générés entre stations voisines (absents du GTFS)
+    size_t m_nbArcsTransferts; //le nombre d'arcs ajoutés par les transferts (et les chaînes d'attente)
+    MetriquesReseau m_metriques; //mesures de la construction
+
+    struct Requete //un point origine, un point destination et une heure de départ, reliés au réseau
+    {
+        Heure heureDepart; //l'heure de départ du point d'origine
+        ParametresRecherche parametres; //la marche permise et les contraintes de correspondance de la requête
+        Coordonnees pointOrigine; //les coordonnées du point d'origine
+        Coordonnees pointDestination; //les coordonnées du point destination
+        std::vector<size_t> stationsOrigine; //sommets (dans m_grapheStations) des stations reliées au point origine
+        std::vector<std::pair<size_t, unsigned int> > stationsDestination; //<sommet de la station, temps de marche vers la destination>
+        Graphe::ArcsTemporaires arcs; //arcs du point origine et vers le point destination
+
+        Requete() : heureDepart(0, 0, 0), pointOrigine(0, 0), pointDestination(0, 0) {}
+    };
 
     bool m_origine_dest_ajoute; //indique si on a ajouté le point origine, le point destination, et les arcs correspondants
+    Requete m_requete; //la requête dont les arcs ont été ajoutés au graphe par ajouterArcsOrigineDestination()
     size_t m_sommetOrigine; //le sommet du graphe qui représente le point d'origine
     size_t m_sommetDestination; //le sommet du graphe qui représente le point destination
     size_t m_nbArcsOrigineVersStations; //le nombre d'arcs du point origine vers des stations
     size_t m_nbArcsStationsVersDestination; //le nombre d'arcs d'une station vers le point destination
 
-    const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia */
-    const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
-    const unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
-    const unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
+    struct Troncon //une étape d'un chemin: debut et fin sont des positions dans le chemin
+    {
+        TypeEtape type;
+        size_t debut; //MARCHE: dernier sommet de la station quittée; AUTOBUS: sommet de l'embarquement
+        size_t fin; //MARCHE: premier sommet de la station atteinte; AUTOBUS: sommet de la descente
+    };
 
+    void genererTransfertsMarche(const DonneesGTFS &, std::vector<TransfertsPietons::Transfert> &); //transferts à pied entre stations voisines
     void ajouterArcsVoyages(const DonneesGTFS &); //ajout des arcs dus aux voyages
+    void construireDeparts(const DonneesGTFS &); //regroupement des arrêts de chaque station par ligne
+    void compresserChemin(const std::vector<size_t> &, std::vector<Troncon> &) const; //étapes d'un chemin du graphe
+    void preparerRequete(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                         const ParametresRecherche &, Requete &) const; //arcs reliant une requête au réseau
+    Itineraire rechercher(const DonneesGTFS &, const Requete &, bool, long &,
+                          StatistiquesRecherche *) const; //recherche d'une requête, avec ou sans arcs temporaires
+    void cleItineraire(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &,
+                       const ParametresRecherche &, unsigned int, CleItineraire &) const; //clé d'une requête dans un CacheItineraires
     void ajouterArcsTransferts(const DonneesGTFS &); //ajout des arcs dus aux transferts
+    void ajouterArcsAttente(); //ajout des sommets et des arcs des chaînes d'attente
+    void ajouterArcsTransfertsAttente(const DonneesGTFS &); //ajout des arcs de transferts vers les chaînes d'attente
 
 };
 
@@ -5,8 +5,24 @@
 
 #include "auxiliaires.h"
 
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
 using namespace std;;
 
+//! \brief lit 8 octets consécutifs dans un entier dont l'octet de poids faible est le premier caractère
+static inline uint64_t lireHuitOctets(const char *p_debut)
+{
+    uint64_t v;
+    memcpy(&v, p_debut, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
 /*!
  * \brief Constructeur par défaut de la classe.
  * Permet d'initialiser un objet Date qui est la date actuelle
@@ -15,7 +31,8 @@ using namespace std;;
 Date::Date()
 {
     time_t lt = time(nullptr);   //epoch seconds
-    struct tm *p = localtime(&lt);
+    struct tm local; //localtime_r plutôt que localtime: sans tampon statique, donc sûr entre fils d'exécution
+    struct tm *p = localtime_r(&lt, &local);
     m_an = (unsigned int) (p->tm_year + 1900);
     m_mois = (unsigned int) (p->tm_mon + 1);
     m_jour = (unsigned int) (p->tm_mday);
@@ -38,6 +55,31 @@ Date::Date(unsigned int p_an, unsigned int p_mois, unsigned int p_jour)
     encode(p_an, p_mois, p_jour);
 }
 
+/*!
+ * \brief Lit une date GTFS au format AAAAMMJJ (calendar_dates.txt) directement à partir de ses caractères.
+ * Les huit chiffres sont validés et convertis simultanément dans un entier de 64 bits (SWAR).
+ * \param[in] p_debut: le premier caractère de la date
+ * \param[in] p_fin: la position suivant le dernier caractère de la date
+ * \exception logic_error si la date n'a pas exactement huit chiffres
+ * \return la date lue
+ */
+Date Date::depuisGTFS(const char *p_debut, const char *p_fin)
+{
+    if (p_fin - p_debut != 8) throw logic_error("Date::depuisGTFS(): une date doit avoir le format AAAAMMJJ");
+    uint64_t v = lireHuitOctets(p_debut);
+    const uint64_t zeros = 0x3030303030303030ULL;
+    uint64_t chiffres = v - zeros;
+    //chaque octet doit être entre '0' et '9': le quartet haut vaut 3 et le quartet bas ne dépasse pas 9
+    if ((v & 0xF0F0F0F0F0F0F0F0ULL) != zeros || ((chiffres + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0)
+        throw logic_error("Date::depuisGTFS(): une date doit avoir le format AAAAMMJJ");
+    //octets 0, 2, 4, 6: 10 * premier chiffre + second chiffre de chaque paire
+    uint64_t paires = chiffres * 10 + (chiffres >> 8);
+    unsigned int an = (unsigned int) (paires & 0xFF) * 100 + (unsigned int) ((paires >> 16) & 0xFF);
+    unsigned int mois = (unsigned int) ((paires >> 32) & 0xFF);
+    unsigned int jour = (unsigned int) ((paires >> 48) & 0xFF);
+    return Date(an, mois, jour);
+}
+
 /*!
  * \brief Égalité entre deux dates
  * Deux dates sont égales s'ils ont la même année, le même mois, le même jour
@@ -125,115 +167,57 @@ std::ostream &operator<<(std::ostream &flux, const Date &p_date)
 Heure::Heure()
 {
     time_t lt = time(nullptr);   //epoch seconds
-    struct tm *p = localtime(&lt);
-    m_heure = (unsigned int) (p->tm_hour);
-    m_min = (unsigned int) (p->tm_min);
-    m_sec = (unsigned int) (p->tm_sec);
-    encode(m_heure, m_min, m_sec);
-}
-
-/*!
- * \brief Constructeur avec paramètre de la classe Heure. Instancie une Heure avec les paramètres.
- * \param[in] p_heure: le nombre d'heure de l'heure à instancier
- * \param[in] p_min: le nombre de minutes dans l'heure
- * \param[in] p_sec: le nombre de secondes dans la minute
- */
-Heure::Heure(unsigned int p_heure, unsigned int p_min, unsigned int p_sec)
-{
-    m_heure = p_heure;
-    m_min = p_min;
-    m_sec = p_sec;
-    encode(m_heure, m_min, m_sec);
-}
-
-/*!
- * \brief Égalité entre deux heures
- * Deux heures sont égales s'ils ont la même heure, la même minute et la même seconde
- * \param[in] other: l'autre heure avec qui l'on se compare
- * \return True ssi les deux Heures sont égales.
- *
- */
-bool Heure::operator==(const Heure &other) const
-{
-    return m_code == other.m_code;
-}
-
-/*!
- * \brief Inégalité inférieure stricte entre deux heures
- * \param[in] other: l'autre heure avec qui l'on se compare
- * \return True ssi les l'Heure de l'objet courant est inférieur à celle de l'objet en paramètre.
- */
-bool Heure::operator<(const Heure &other) const
-{
-    return m_code < other.m_code;
-}
-
-/*!
- * \brief Inégalité supérieure stricte entre deux heures
- * \param[in] other: l'autre heure avec qui l'on se compare
- * \return True ssi les l'Heure de l'objet courant est supérieur à celle de l'objet en paramètre.
- */
-bool Heure::operator>(const Heure &other) const
-{
-    return m_code > other.m_code;
+    struct tm local; //voir Date::Date()
+    struct tm *p = localtime_r(&lt, &local);
+    m_code = Heure((unsigned int) (p->tm_hour), (unsigned int) (p->tm_min), (unsigned int) (p->tm_sec)).m_code;
 }
 
 /*!
- * \brief Inégalité inférieure entre deux heures
- * \param[in] other: l'autre heure avec qui l'on se compare
- * \return True ssi les l'Heure de l'objet courant est inférieur ou égale à celle de l'objet en paramètre.
+ * \brief Lit une heure GTFS (stop_times.txt) au format H:MM:SS, HH:MM:SS ou HHH:MM:SS directement à partir de ses caractères.
+ * Le nombre d'heures peut dépasser 24 (voyages se terminant après minuit). Le format usuel HH:MM:SS, celui de la boucle
+ * de lecture de stop_times.txt, est validé et converti d'un bloc dans un entier de 64 bits (SWAR);
+ * les autres longueurs sont lues caractère par caractère.
+ * \param[in] p_debut: le premier caractère de l'heure
+ * \param[in] p_fin: la position suivant le dernier caractère de l'heure
+ * \exception logic_error si le format n'est pas respecté ou si les minutes ou les secondes dépassent 59
+ * \return l'heure lue
  */
-bool Heure::operator<=(const Heure &other) const
+Heure Heure::depuisGTFS(const char *p_debut, const char *p_fin)
 {
-    return m_code <= other.m_code;
-}
-
-/*!
- * \brief Inégalité supérieure entre deux heures
- * \param[in] other: l'autre heure avec qui l'on se compare
- * \return True ssi les l'Heure de l'objet courant est supérieur ou égale à celle de l'objet en paramètre.
- */
-bool Heure::operator>=(const Heure &other) const
-{
-    return m_code >= other.m_code;
-}
-
-/*!
- * \brief Différence entre deux heures
- * \param[in] other: l'autre heure avec qui l'on fait l'opération
- * \return le nombre de secondes (positif ou négatif) qui sépare les deux heures.
- */
-int Heure::operator-(const Heure &other) const
-{
-    return m_code - other.m_code;
-}
-
-/*!
- * \brief Ajoute un certain nombre de secondes à l'heure de l'objet courant
- * \param[in] secs: le nombre de secondes à ajouter
- * \return la nouvelle heure obtenue après l'ajout des secondes
- */
-Heure Heure::add_secondes(unsigned int secs) const
-{
-    unsigned int code = m_code + secs; //la nouvelle heure en secondes
-    unsigned int h = code / 3600; //le nombre d'heures de cette nouvelle heure
-    unsigned int reste = code % 3600; //le reste en secondes
-    unsigned int m = reste / 60; //le nombre de minutes de cette nouvelle heure
-    unsigned int s = reste % 60; //le nombre de secondes de cette nouvelle heure
+    unsigned int h = 0;
+    unsigned int m;
+    unsigned int s;
+    if (p_fin - p_debut == 8)
+    {
+        uint64_t v = lireHuitOctets(p_debut);
+        const uint64_t zeros = 0x3030303030303030ULL;
+        uint64_t chiffres = v - zeros; //les ':' (0x3A) deviennent 0x0A
+        //quartet haut à 3 partout, quartet bas à au plus 9 sauf aux octets 2 et 5 où il vaut exactement 0xA (':')
+        if ((v & 0xF0F0F0F0F0F0F0F0ULL) != zeros
+            || ((chiffres + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x0000100000100000ULL
+            || (chiffres & 0x0000FF0000FF0000ULL) != 0x00000A00000A0000ULL)
+            throw logic_error("Heure::depuisGTFS(): une heure doit avoir le format HH:MM:SS");
+        //octets 0, 3, 6: 10 * premier chiffre + second chiffre de chaque paire
+        uint64_t paires = chiffres * 10 + (chiffres >> 8);
+        h = (unsigned int) (paires & 0xFF);
+        m = (unsigned int) ((paires >> 24) & 0xFF);
+        s = (unsigned int) ((paires >> 48) & 0xFF);
+    }
+    else
+    {
+        const char *c = p_debut;
+        while (c < p_fin && *c >= '0' && *c <= '9') h = 10 * h + (unsigned int) (*c++ - '0');
+        if (c == p_debut || c - p_debut > 3 || p_fin - c != 6 || c[0] != ':' || c[3] != ':'
+            || c[1] < '0' || c[1] > '9' || c[2] < '0' || c[2] > '9'
+            || c[4] < '0' || c[4] > '9' || c[5] < '0' || c[5] > '9')
+            throw logic_error("Heure::depuisGTFS(): une heure doit avoir le format HH:MM:SS");
+        m = (unsigned int) (10 * (c[1] - '0') + (c[2] - '0'));
+        s = (unsigned int) (10 * (c[4] - '0') + (c[5] - '0'));
+    }
+    if (m > 59 || s > 59) throw logic_error("Heure::depuisGTFS(): minutes ou secondes invalides");
     return Heure(h, m, s);
 }
 
-/*!
- * \brief Encode et modifie l'attribut hour_code de l'objet. L'encodage revient à déterminier le nombre de secondes depuis 00h00m00s
- * \param[in] p_heure: le nombre d'heure de l'heure à instancier
- * \param[in] p_min: le nombre de minutes dans l'heure
- * \param[in] p_sec: le nombre de secondes dans la minute
- */
-void Heure::encode(unsigned int p_heure, unsigned int p_min, unsigned int p_sec)
-{
-    m_code = (((60 * p_heure) + p_min) * 60) + p_sec;
-}
-
 /*!
  * \brief Permet l'affichage d'une heure au format HH:MM:SS
  * \param[in,out] flux: le flux de sortie utilisé pour l'affichage
@@ -242,28 +226,66 @@ void Heure::encode(unsigned int p_heure, unsigned int p_min, unsigned int p_sec)
  */
 std::ostream &operator<<(std::ostream &flux, const Heure &p_heure)
 {
-    if (p_heure.m_heure < 10)
+    unsigned int heure = p_heure.m_code / 3600;
+    unsigned int min = p_heure.m_code % 3600 / 60;
+    unsigned int sec = p_heure.m_code % 60;
+
+    if (heure < 10)
     {
-        flux << "0" << p_heure.m_heure << ":";
+        flux << "0" << heure << ":";
     } else
     {
-        flux << p_heure.m_heure << ":";
+        flux << heure << ":";
     }
 
-    if (p_heure.m_min < 10)
+    if (min < 10)
     {
-        flux << "0" << p_heure.m_min << ":";
+        flux << "0" << min << ":";
     } else
     {
-        flux << p_heure.m_min << ":";
+        flux << min << ":";
     }
 
-    if (p_heure.m_sec < 10)
+    if (sec < 10)
     {
-        flux << "0" << p_heure.m_sec;
+        flux << "0" << sec;
     } else
     {
-        flux << p_heure.m_sec;
+        flux << sec;
     }
     return flux;
 }
+
+//! \brief lit un entier de [p_min, p_max], écrit en chiffres décimaux seulement (sans signe, espace ni exposant)
+//! \param[in] p_nom: le nom de la valeur, repris dans le message d'erreur
+//! \throws logic_error si p_texte n'est pas un tel entier ou s'il sort de [p_min, p_max]
+unsigned long lireEntierBorne(const std::string &p_nom, const std::string &p_texte, unsigned long p_min,
+                              unsigned long p_max)
+{
+    if (p_texte.empty() || !all_of(p_texte.begin(), p_texte.end(), [](unsigned char c) { return isdigit(c) != 0; }))
+        throw logic_error(p_nom + ": entier invalide: " + p_texte);
+    errno = 0;
+    unsigned long valeur = strtoul(p_texte.c_str(), nullptr, 10);
+    //un dépassement (ERANGE) est hors des bornes comme toute autre valeur trop grande
+    if (errno == ERANGE || valeur < p_min || valeur > p_max)
+        throw logic_error(p_nom + " doit être dans [" + to_string(p_min) + ", " + to_string(p_max) + "]: " + p_texte);
+    return valeur;
+}
+
+//! \brief lit un nombre fini de [p_min, p_max] (p_min exclu si p_minExclu)
+//! \param[in] p_nom: le nom de la valeur, repris dans le message d'erreur
+//! \throws logic_error si p_texte n'est pas un nombre fini ou s'il sort de ses bornes
+double lireReelBorne(const std::string &p_nom, const std::string &p_texte, double p_min, bool p_minExclu, double p_max)
+{
+    char *fin = nullptr;
+    double valeur = strtod(p_texte.c_str(), &fin);
+    if (p_texte.empty() || *fin != '\0' || !std::isfinite(valeur))
+        throw logic_error(p_nom + ": nombre invalide: " + p_texte);
+    if (valeur < p_min || (p_minExclu && valeur == p_min) || valeur > p_max)
+    {
+        ostringstream message;
+        message << p_nom << " doit être dans " << (p_minExclu ? "]" : "[") << p_min << ", " << p_max << "]: " << p_texte;
+        throw logic_error(message.str());
+    }
+    return valeur;
+}
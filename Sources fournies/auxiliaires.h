@@ -14,6 +14,8 @@
 #include "time.h"
 #include <unordered_set>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 /*!
  * \class Date
@@ -25,6 +27,7 @@ class Date
 public:
     Date();
     Date(unsigned int an, unsigned int mois, unsigned int jour);
+    static Date depuisGTFS(const char *p_debut, const char *p_fin);
     bool operator==(const Date &other) const;
     bool operator<(const Date &other) const;
     bool operator>(const Date &other) const;
@@ -46,30 +49,71 @@ private:
  * \class Heure
  * \brief Cette classe représente l'heure d'une journée.
  * Cependant pour les besoins du travail pratique nous permettont qu'elle puisse encoder un nombre d'heures supérieurs à 24
+ * L'heure est encodée par un seul entier (le nombre de secondes depuis 00h00m00s du jour de service): les comparaisons
+ * et les différences, omniprésentes dans la construction du graphe et les recherches d'itinéraires, se réduisent à une
+ * instruction; les heures, minutes et secondes ne sont calculées qu'à l'affichage.
  */
 class Heure
 {
 public:
     Heure();
 
-    Heure(unsigned int heure, unsigned int min, unsigned int sec);
-    Heure add_secondes(unsigned int secs) const;
-    bool operator==(const Heure &other) const;
-    bool operator<(const Heure &other) const;
-    bool operator>(const Heure &other) const;
-    bool operator<=(const Heure &other) const;
-    bool operator>=(const Heure &other) const;
-    int operator-(const Heure &other) const;
+    //! \brief instancie une Heure à partir d'un nombre d'heures, de minutes et de secondes
+    constexpr Heure(unsigned int heure, unsigned int min, unsigned int sec)
+            : m_code(((60 * heure) + min) * 60 + sec)
+    {
+    }
+
+    static Heure depuisGTFS(const char *p_debut, const char *p_fin);
+
+    //! \brief retourne l'heure obtenue après l'ajout de secs secondes
+    constexpr Heure add_secondes(unsigned int secs) const
+    {
+        return Heure(0, 0, m_code + secs);
+    }
+
+    constexpr bool operator==(const Heure &other) const
+    {
+        return m_code == other.m_code;
+    }
+
+    constexpr bool operator<(const Heure &other) const
+    {
+        return m_code < other.m_code;
+    }
+
+    constexpr bool operator>(const Heure &other) const
+    {
+        return m_code > other.m_code;
+    }
+
+    constexpr bool operator<=(const Heure &other) const
+    {
+        return m_code <= other.m_code;
+    }
+
+    constexpr bool operator>=(const Heure &other) const
+    {
+        return m_code >= other.m_code;
+    }
+
+    //! \brief retourne le nombre de secondes (positif ou négatif) qui sépare les deux heures
+    constexpr int operator-(const Heure &other) const
+    {
+        return (int) m_code - (int) other.m_code;
+    }
+
     friend std::ostream &operator<<(std::ostream &flux, const Heure &p_heure);
 
 private:
-    unsigned int m_code;
-    unsigned int m_heure;
-    unsigned int m_min;
-    unsigned int m_sec;
-
-    void encode(unsigned int heure, unsigned int min, unsigned int sec);
+    unsigned int m_code; // nombre de secondes depuis 00h00m00s
 };
 
+//lecture vérifiée d'une valeur numérique donnée sous forme de texte (option de la ligne de commande, paramètre d'une
+//requête): aucune valeur invalide n'est remplacée silencieusement
+unsigned long lireEntierBorne(const std::string &p_nom, const std::string &p_texte, unsigned long p_min,
+                              unsigned long p_max);
+double lireReelBorne(const std::string &p_nom, const std::string &p_texte, double p_min, bool p_minExclu, double p_max);
+
 
 #endif //RTC_AUXILIAIRES_H
@@ -0,0 +1,133 @@
+//
+// Cache des itinéraires calculés (origine, destination et intervalle de départ)
+//
+
+#include "cacheItineraires.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+bool CleItineraire::operator==(const CleItineraire &p_autre) const
+{
+    return intervalle == p_autre.intervalle && correspondancesMax == p_autre.correspondancesMax &&
+           penaliteCorrespondance == p_autre.penaliteCorrespondance && origine == p_autre.origine &&
+           destination == p_autre.destination;
+}
+
+size_t HachageCleItineraire::operator()(const CleItineraire &p_cle) const
+{
+    uint64_t h = 1469598103934665603ULL ^ p_cle.intervalle; //FNV-1a sur les entiers de la clé
+    auto melanger = [&h](uint64_t p_valeur)
+    {
+        h ^= p_valeur;
+        h *= 1099511628211ULL;
+    };
+    melanger((uint64_t(p_cle.correspondancesMax) << 32) | p_cle.penaliteCorrespondance);
+    for (const auto &s : p_cle.origine) melanger((uint64_t(s.first) << 32) | s.second);
+    melanger(p_cle.origine.size());
+    for (const auto &s : p_cle.destination) melanger((uint64_t(s.first) << 32) | s.second);
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+//! \brief construit un cache vide
+//! \param[in] p_capacite: le nombre maximal d'itinéraires conservés
+//! \param[in] p_largeurIntervalle: la largeur, en secondes, des intervalles de départ (voir ReseauGTFS::itineraireEnCache())
+//! \throws logic_error si la capacité ou la largeur est nulle
+CacheItineraires::CacheItineraires(size_t p_capacite, unsigned int p_largeurIntervalle)
+        : m_capacite(p_capacite), m_largeurIntervalle(p_largeurIntervalle), m_reseau(0)
+{
+    if (p_capacite == 0) throw logic_error("CacheItineraires: la capacité doit être positive");
+    if (p_largeurIntervalle == 0) throw logic_error("CacheItineraires: la largeur des intervalles doit être positive");
+    m_index.reserve(p_capacite);
+}
+
+//! \brief cherche l'itinéraire d'une clé, valide pour une heure de départ; s'il l'est, il devient le plus récemment utilisé
+//! \brief Un itinéraire calculé pour un départ h0 reste optimal pour tout départ dans [h0, itineraire.departAuPlusTard]:
+//! \brief un départ plus tardif ne peut arriver plus tôt. Une destination non atteignable l'est aussi pour tout départ
+//! \brief après h0, et une durée nulle vaut pour tout départ.
+//! \param[in] p_reseau: l'identifiant du réseau interrogé
+//! \param[in] p_heureDepart: l'heure de départ de la requête
+//! \param[out] p_itineraire: reçoit l'itinéraire conservé, s'il est valide
+//! \return true si la clé est présente et son itinéraire valide pour p_heureDepart
+bool CacheItineraires::chercher(uint64_t p_reseau, const CleItineraire &p_cle, const Heure &p_heureDepart,
+                                Itineraire &p_itineraire)
+{
+    verifierReseau(p_reseau);
+    auto itr = m_index.find(p_cle);
+    if (itr == m_index.end() || !estValide(itr->second->second, p_heureDepart))
+    {
+        ++m_statistiques.echecs;
+        return false;
+    }
+    ++m_statistiques.succes;
+    m_entrees.splice(m_entrees.begin(), m_entrees, itr->second);
+    p_itineraire = itr->second->second;
+    return true;
+}
+
+//! \brief conserve l'itinéraire d'une clé, en retirant au besoin l'entrée la moins récemment utilisée
+//! \param[in] p_reseau: l'identifiant du réseau qui a calculé l'itinéraire
+void CacheItineraires::inserer(uint64_t p_reseau, const CleItineraire &p_cle, const Itineraire &p_itineraire)
+{
+    verifierReseau(p_reseau);
+    auto itr = m_index.find(p_cle);
+    if (itr != m_index.end())
+    {
+        itr->second->second = p_itineraire;
+        m_entrees.splice(m_entrees.begin(), m_entrees, itr->second);
+        return;
+    }
+    if (m_entrees.size() == m_capacite)
+    {
+        m_index.erase(m_entrees.back().first);
+        m_entrees.pop_back();
+        ++m_statistiques.evictions;
+    }
+    m_entrees.emplace_front(p_cle, p_itineraire);
+    m_index.emplace(p_cle, m_entrees.begin());
+}
+
+//! \brief retire toutes les entrées
+void CacheItineraires::vider()
+{
+    if (!m_entrees.empty()) ++m_statistiques.invalidations;
+    m_entrees.clear();
+    m_index.clear();
+}
+
+size_t CacheItineraires::getTaille() const
+{
+    return m_entrees.size();
+}
+
+size_t CacheItineraires::getCapacite() const
+{
+    return m_capacite;
+}
+
+unsigned int CacheItineraires::getLargeurIntervalle() const
+{
+    return m_largeurIntervalle;
+}
+
+const StatistiquesCache &CacheItineraires::getStatistiques() const
+{
+    return m_statistiques;
+}
+
+//vrai si l'itinéraire conservé est celui qu'une recherche faite à p_heureDepart trouverait
+bool CacheItineraires::estValide(const Itineraire &p_itineraire, const Heure &p_heureDepart)
+{
+    if (p_itineraire.atteignable && p_itineraire.duree == 0) return true;
+    if (p_heureDepart < p_itineraire.heureDepart) return false;
+    return !p_itineraire.atteignable || !(p_itineraire.departAuPlusTard < p_heureDepart);
+}
+
+//vide le cache si ses entrées ont été calculées par un autre réseau
+void CacheItineraires::verifierReseau(uint64_t p_reseau)
+{
+    if (p_reseau == m_reseau) return;
+    vider();
+    m_reseau = p_reseau;
+}
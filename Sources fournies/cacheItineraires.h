@@ -0,0 +1,83 @@
+//
+// Cache des itinéraires calculés (origine, destination et intervalle de départ)
+//
+
+#ifndef RTC_CACHEITINERAIRES_H
+#define RTC_CACHEITINERAIRES_H
+
+#include <list>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "ReseauGTFS.h"
+
+//! \brief clé d'une requête d'itinéraire (voir ReseauGTFS::itineraireEnCache())
+//! \brief Deux requêtes de même clé produisent la même recherche, à l'heure de départ près: mêmes stations reliées à
+//! \brief chaque point, avec les mêmes temps de marche, et mêmes contraintes de correspondance. L'intervalle de départ permet de conserver des
+//! \brief itinéraires à différentes heures pour un même couple origine/destination.
+struct CleItineraire
+{
+    std::vector<std::pair<unsigned int, unsigned int> > origine; //<station_id, temps de marche>, par station_id croissant
+    std::vector<std::pair<unsigned int, unsigned int> > destination; //idem, pour le point destination
+    unsigned int correspondancesMax = 0; //les contraintes de correspondance de la requête (voir ParametresRecherche)
+    unsigned int penaliteCorrespondance = 0;
+    unsigned int intervalle = 0; //numéro de l'intervalle de départ (secondes depuis minuit / largeur de l'intervalle)
+
+    bool operator==(const CleItineraire &p_autre) const;
+};
+
+struct HachageCleItineraire
+{
+    size_t operator()(const CleItineraire &p_cle) const;
+};
+
+//! \brief compteurs d'un CacheItineraires
+struct StatistiquesCache
+{
+    size_t succes = 0; //requêtes servies par le cache
+    size_t echecs = 0; //requêtes absentes du cache, ou dont l'itinéraire conservé ne vaut pas pour leur départ
+    size_t evictions = 0; //entrées retirées pour respecter la capacité
+    size_t invalidations = 0; //vidages dus à un changement de réseau (ou à vider())
+};
+
+/*!
+ * \class CacheItineraires
+ * \brief Cache LRU (moins récemment utilisé) des itinéraires, de capacité bornée en nombre d'entrées.
+ * Les entrées appartiennent au réseau (ReseauGTFS::getIdentifiant()) qui les a calculées: une recherche ou une insertion
+ * pour un autre réseau vide d'abord le cache, de sorte qu'un itinéraire n'est jamais servi à partir d'un réseau périmé.
+ * \note Le cache n'est pas protégé contre les accès concurrents.
+ */
+class CacheItineraires
+{
+
+public:
+    explicit CacheItineraires(size_t p_capacite = 4096, unsigned int p_largeurIntervalle = 300);
+
+    bool chercher(uint64_t p_reseau, const CleItineraire &p_cle, const Heure &p_heureDepart, Itineraire &p_itineraire);
+    void inserer(uint64_t p_reseau, const CleItineraire &p_cle, const Itineraire &p_itineraire);
+    void vider();
+
+    size_t getTaille() const;
+    size_t getCapacite() const;
+    unsigned int getLargeurIntervalle() const;
+    const StatistiquesCache &getStatistiques() const;
+
+private:
+    typedef std::list<std::pair<CleItineraire, Itineraire> > Entrees;
+
+    size_t m_capacite;
+    unsigned int m_largeurIntervalle; //en secondes
+    uint64_t m_reseau; //identifiant du réseau des entrées (0 = aucun)
+    Entrees m_entrees; //de la plus récemment utilisée à la moins récemment utilisée
+    std::unordered_map<CleItineraire, Entrees::iterator, HachageCleItineraire> m_index;
+    StatistiquesCache m_statistiques;
+
+    void verifierReseau(uint64_t p_reseau);
+    static bool estValide(const Itineraire &p_itineraire, const Heure &p_heureDepart);
+};
+
+
+#endif //RTC_CACHEITINERAIRES_H
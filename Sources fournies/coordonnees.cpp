@@ -4,8 +4,12 @@
 
 #include "coordonnees.h"
 
+constexpr double Coordonnees::rayonTerre;
+
 /*!
  * \brief Constructeur de la classe, permet de construire une coordonnéees à partir de la longitude et de la latitude.
+ * La position est aussi projetée une fois pour toutes sur la sphère unité (m_x, m_y, m_z), ce qui évite tout appel
+ * trigonométrique lors des calculs de distance. Les copies réutilisent cette projection sans revalider la coordonnée.
  * \exception logic_error si La latitude et/ou la longitude est invalide
  */
 Coordonnees::Coordonnees(double latitude, double longitude) : m_latitude(latitude), m_longitude(longitude)
@@ -14,28 +18,14 @@ Coordonnees::Coordonnees(double latitude, double longitude) : m_latitude(latitud
     {
         throw std::logic_error("La latitude ou la longitude est invalide");
     }
-
+    double radParDegre = 3.14159265358979323846 / 180.0;
+    double lat = latitude * radParDegre;
+    double lon = longitude * radParDegre;
+    m_x = cos(lat) * cos(lon);
+    m_y = cos(lat) * sin(lon);
+    m_z = sin(lat);
 };
 
-/*!
- * \brief Constructeur de copie de la classe, permet de construire une coordonnéees à partir d'une autre coordonnée.
- * \exception logic_error si La latitude et/ou la longitude de cette coordonnée est invalide
- */
-Coordonnees::Coordonnees(const Coordonnees & rhs)
-{
-    if (this != &rhs)
-    {
-        double longitude = rhs.getLongitude();
-        double latitude = rhs.getLatitude();
-        if (!Coordonnees::is_valide_coord(latitude, longitude))
-        {
-            throw std::logic_error("Coordonnees::Coordonnees(): rhs est une coordonnée invalide");
-        }
-        m_longitude = rhs.getLongitude();
-        m_latitude = rhs.getLatitude();
-    }
-}
-
 double Coordonnees::getLatitude() const
 {
     return m_latitude;
@@ -46,6 +36,21 @@ double Coordonnees::getLongitude() const
     return m_longitude;
 };
 
+double Coordonnees::getX() const
+{
+    return m_x;
+};
+
+double Coordonnees::getY() const
+{
+    return m_y;
+};
+
+double Coordonnees::getZ() const
+{
+    return m_z;
+};
+
 /*!
  * \brief : Cette fonction vérifie si les longitude et latitude en argument représentent
  * une coordonnée gps valide. Voir https://en.wikipedia.org/wiki/Geographic_coordinate_system
@@ -59,23 +64,31 @@ bool Coordonnees::is_valide_coord(double p_latitude, double p_longitude)
            && p_longitude >= -180.0 && p_longitude <= 180.0;
 };
 
+/*!
+ * \brief Convertit la longueur d'une corde de la sphère unité en distance sur le grand cercle: 2 R asin(corde / 2).
+ * \param[in] p_corde: la distance euclidienne entre deux vecteurs unitaires (entre 0 et 2)
+ * \return La distance, en km, le long du grand cercle
+ */
+double Coordonnees::distanceDeCorde(double p_corde)
+{
+    return 2 * rayonTerre * asin(std::min(p_corde / 2, 1.0));
+};
+
 /*!
  * \brief Cet opérateur calcule la distance entre la coordonnée courante et celle passée en paramètre.
  * La formule de calcul est disponible à l'adresse https://en.wikipedia.org/wiki/Great-circle_distance. \n
+ * Elle passe par la corde entre les deux vecteurs unitaires précalculés (un seul appel trigonométrique), ce qui est
+ * aussi plus précis que la loi des cosinus sphérique pour les courtes distances. \n
  * Notez qu'il s'agit d'une approximation de la distance à vol d'oiseau et donc pas très réaliste dans certains cas.
  * \param[in] other: est la seconde coordonnée gps
  * \return La distance, en km, entre les deux coordonnées
  */
 double Coordonnees::operator-(const Coordonnees &other) const
 {
-    double radParDegre = 3.14159265358979323846 / 180.0;
-    double rayonTerre = 6371; //en km
-    double lon1 = m_longitude * radParDegre;
-    double lat1 = m_latitude * radParDegre;
-    double lon2 = other.m_longitude * radParDegre;
-    double lat2 = other.m_latitude * radParDegre;
-    double res = rayonTerre * acos(cos(lat1) * cos(lat2) * cos(lon2 - lon1) + sin(lat1) * sin(lat2));
-    return res;
+    double dx = m_x - other.m_x;
+    double dy = m_y - other.m_y;
+    double dz = m_z - other.m_z;
+    return distanceDeCorde(sqrt(dx * dx + dy * dy + dz * dz));
 };
 
 /*!
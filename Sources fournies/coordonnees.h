@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 /*!
  * \class Coordonnees
@@ -20,17 +21,25 @@ class Coordonnees {
 
 public:
 
+    static constexpr double rayonTerre = 6371.0; //en km
+
     Coordonnees(double latitude, double longitude);
-    Coordonnees(const Coordonnees & rhs);
     double getLatitude() const ;
     double getLongitude() const ;
+    double getX() const ;
+    double getY() const ;
+    double getZ() const ;
     static bool is_valide_coord(double p_latitude, double p_longitude) ;
+    static double distanceDeCorde(double p_corde);
     double operator- (const Coordonnees & other) const;
     friend std::ostream & operator<<(std::ostream & flux, const Coordonnees & p_coord);
 
 private:
     double m_latitude;
     double m_longitude;
+    double m_x; //(m_x, m_y, m_z): vecteur unitaire de la position sur la sphère terrestre, calculé à la construction
+    double m_y;
+    double m_z;
 };
 
 
@@ -46,6 +46,16 @@ size_t Graphe::getNbArcs() const
     return m_nbArcs;
 }
 
+//! \brief retourne la mémoire allouée par les listes d'adjacence
+MemoirePartie Graphe::memoireUtilisee() const
+{
+    MemoirePartie memoire;
+    memoire.partie = "adjacence";
+    ajouterMemoire(memoire, m_listesAdj);
+    for (const auto &liste : m_listesAdj) ajouterMemoire(memoire, liste);
+    return memoire;
+}
+
 //! \brief ajoute un arc d'un poids donné dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
@@ -65,6 +75,44 @@ void Graphe::ajouterArc(size_t i, size_t j, unsigned int poids)
     ++m_nbArcs;
 }
 
+//! \brief ajoute en bloc des arcs produits, par exemple, par plusieurs fils d'exécution
+//! \param[in] p_tampons: les tampons d'arcs <i, j, poids>
+//! \param[in] p_marques: vrai si les arcs ajoutés sont marqués (voir ContraintesChemin)
+//! \post le graphe obtenu est identique à celui obtenu en appelant ajouterArc() sur chaque arc de p_tampons[0],
+//! puis de p_tampons[1], etc.; la capacité de chaque liste d'adjacence est réservée une seule fois
+//! \throws logic_error (sans ajouter d'arc) lorsqu'un arc est invalide, comme pour ajouterArc()
+void Graphe::ajouterArcs(const std::vector<TamponArcs> &p_tampons, bool p_marques)
+{
+    vector<size_t> nbAjouts(m_listesAdj.size(), 0);
+    size_t total = 0;
+    for (const auto &tampon : p_tampons)
+    {
+        for (const auto &arc : tampon)
+        {
+            if (get<0>(arc) >= m_listesAdj.size())
+                throw logic_error("Graphe::ajouterArcs(): tentative d'ajouter l'arc(i,j) avec un sommet i inexistant");
+            if (get<1>(arc) >= m_listesAdj.size())
+                throw logic_error("Graphe::ajouterArcs(): tentative d'ajouter l'arc(i,j) avec un sommet j inexistant");
+            if (get<2>(arc) == numeric_limits<unsigned int>::max())
+                throw logic_error("Graphe::ajouterArcs(): valeur de poids interdite");
+            ++nbAjouts[get<0>(arc)];
+        }
+        total += tampon.size();
+    }
+    for (size_t i = 0; i < m_listesAdj.size(); ++i)
+    {
+        if (nbAjouts[i]) m_listesAdj[i].reserve(m_listesAdj[i].size() + nbAjouts[i]);
+    }
+    for (const auto &tampon : p_tampons)
+    {
+        for (const auto &arc : tampon)
+        {
+            m_listesAdj[get<0>(arc)].emplace_back(get<1>(arc), get<2>(arc), p_marques);
+        }
+    }
+    m_nbArcs += total;
+}
+
 //! \brief enlève un arc dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
@@ -108,39 +156,191 @@ unsigned int Graphe::getPoids(size_t i, size_t j) const
 
 
 //! \brief Algorithme de Dijkstra permettant de trouver le plus court chemin entre p_origine et p_destination
+//! \brief Lorsque des potentiels sont fournis, la recherche est guidée (A*) par ces bornes inférieures de la distance restante
 //! \pre p_origine et p_destination doivent être des sommets du graphe
+//! \pre les potentiels, s'ils sont fournis, doivent être cohérents: pot[i] <= poids(i,j) + pot[j] et pot[p_destination] == 0;
+//! un potentiel de numeric_limits<unsigned int>::max() indique que p_destination n'est pas atteignable du sommet (il est élagué)
 //! \return la longueur du plus court chemin est retournée
 //! \param[out] le chemin est retourné (un seul noeud si p_destination == p_origine ou si p_destination est inatteignable)
+//! \param[in] p_potentiels: nullptr, ou un potentiel par sommet du graphe
+//! \param[out] p_statistiques: nullptr, ou reçoit les compteurs de la recherche; sans compteurs, la version de la
+//! recherche qui est exécutée n'en contient aucun
+//! \param[in] p_contraintes: nullptr, ou la pénalité des arcs marqués et leur nombre maximal; la longueur retournée
+//! est alors le coût du chemin, pénalités comprises
 //! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
 //! \throws logic_error lorsque p_origine ou p_destination n'existe pas
-unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin) const
+//! \throws logic_error lorsque p_potentiels n'a pas un élément par sommet
+unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                     const std::vector<unsigned int> *p_potentiels,
+                                     StatistiquesRecherche *p_statistiques,
+                                     const ContraintesChemin *p_contraintes) const
+{
+    if (p_statistiques) *p_statistiques = StatistiquesRecherche();
+    return rechercher(p_origine, p_destination, p_chemin, p_potentiels, p_statistiques, nullptr, p_contraintes);
+}
+
+//! \brief plus court chemin d'un sommet origine temporaire vers un sommet destination temporaire
+//! \brief Les deux sommets et leurs arcs (p_arcs) ne sont pas ajoutés au graphe: celui-ci n'est pas modifié, de sorte que
+//! \brief plusieurs recherches peuvent être faites simultanément sur un même graphe. Les arcs vers la destination sont
+//! \brief examinés après ceux de la liste d'adjacence de leur sommet, comme s'ils y avaient été ajoutés en dernier.
+//! \param[in] p_arcs: les arcs de l'origine (sommet getNbSommets()) et vers la destination (sommet getNbSommets() + 1)
+//! \param[out] p_chemin: le chemin, de l'origine à la destination (voir l'autre plusCourtChemin())
+//! \param[in] p_potentiels: nullptr, ou un potentiel par sommet, origine et destination comprises
+//! \param[out] p_statistiques: nullptr, ou reçoit les compteurs de la recherche
+//! \param[in] p_contraintes: nullptr, ou les contraintes sur les arcs marqués (voir l'autre plusCourtChemin()); les
+//! arcs temporaires ne sont pas marqués
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination n'est pas atteignable)
+//! \throws logic_error lorsqu'un arc temporaire mène à un sommet inexistant
+//! \throws logic_error lorsque p_potentiels n'a pas un élément par sommet
+unsigned int Graphe::plusCourtChemin(const ArcsTemporaires &p_arcs, std::vector<size_t> &p_chemin,
+                                     const std::vector<unsigned int> *p_potentiels,
+                                     StatistiquesRecherche *p_statistiques,
+                                     const ContraintesChemin *p_contraintes) const
+{
+    size_t origine = m_listesAdj.size();
+    if (p_statistiques) *p_statistiques = StatistiquesRecherche();
+    return rechercher(origine, origine + 1, p_chemin, p_potentiels, p_statistiques, &p_arcs, p_contraintes);
+}
+
+//! \brief choisit la recherche selon les contraintes
+//! \brief Le plus court chemin sans limite d'arcs marqués est cherché d'abord: s'il respecte la limite, il est aussi le
+//! \brief plus court chemin qui la respecte. Sinon seulement, la recherche par étiquettes (plus coûteuse) est faite;
+//! \brief les compteurs des deux recherches s'additionnent.
+unsigned int Graphe::rechercher(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                const std::vector<unsigned int> *p_potentiels, StatistiquesRecherche *p_statistiques,
+                                const ArcsTemporaires *p_arcsTemporaires, const ContraintesChemin *p_contraintes) const
+{
+    unsigned int penalite = p_contraintes ? p_contraintes->penaliteMarque : 0;
+    unsigned int longueur = p_statistiques
+            ? plusCourtCheminImpl<true>(p_origine, p_destination, p_chemin, p_potentiels, p_statistiques,
+                                        p_arcsTemporaires, penalite)
+            : plusCourtCheminImpl<false>(p_origine, p_destination, p_chemin, p_potentiels, nullptr,
+                                         p_arcsTemporaires, penalite);
+    if (!p_contraintes || longueur == numeric_limits<unsigned int>::max() ||
+        nbMarques(p_chemin, penalite) <= p_contraintes->maxMarques)
+        return longueur;
+    if (p_statistiques)
+        return plusCourtCheminContraint<true>(p_origine, p_destination, p_chemin, p_potentiels, p_statistiques,
+                                              p_arcsTemporaires, *p_contraintes);
+    return plusCourtCheminContraint<false>(p_origine, p_destination, p_chemin, p_potentiels, nullptr,
+                                           p_arcsTemporaires, *p_contraintes);
+}
+
+//! \brief compte les arcs marqués d'un chemin trouvé par plusCourtCheminImpl()
+//! \brief Entre deux sommets consécutifs, l'arc emprunté est le premier de poids (pénalité comprise) minimal, comme lors
+//! \brief du relâchement; les arcs qui partent d'un sommet temporaire ou qui y mènent ne sont pas marqués
+size_t Graphe::nbMarques(const std::vector<size_t> &p_chemin, unsigned int p_penaliteMarque) const
+{
+    size_t marques = 0;
+    for (size_t k = 0; k + 1 < p_chemin.size(); ++k)
+    {
+        if (p_chemin[k] >= m_listesAdj.size()) continue;
+        const Arc *choisi = nullptr;
+        unsigned long poidsChoisi = numeric_limits<unsigned long>::max();
+        for (const Arc &arc : m_listesAdj[p_chemin[k]])
+        {
+            unsigned long poids = (unsigned long) arc.poids + (arc.marque ? p_penaliteMarque : 0);
+            if (arc.destination == p_chemin[k + 1] && poids < poidsChoisi)
+            {
+                choisi = &arc;
+                poidsChoisi = poids;
+            }
+        }
+        if (choisi && choisi->marque) ++marques;
+    }
+    return marques;
+}
+
+//! \brief implémentation de plusCourtChemin(); les compteurs ne sont compilés que si AvecStatistiques est vrai
+//! \brief Avec p_arcsTemporaires, p_origine et p_destination sont les deux sommets temporaires qui suivent ceux du graphe
+//! \brief p_penaliteMarque est ajoutée au poids de chaque arc marqué
+template<bool AvecStatistiques>
+unsigned int Graphe::plusCourtCheminImpl(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                         const std::vector<unsigned int> *p_potentiels,
+                                         StatistiquesRecherche *p_statistiques,
+                                         const ArcsTemporaires *p_arcsTemporaires,
+                                         unsigned int p_penaliteMarque) const
 {
-    if (p_origine >= m_listesAdj.size() || p_destination >= m_listesAdj.size())
+    const size_t nbSommetsGraphe = m_listesAdj.size();
+    const size_t nbSommets = nbSommetsGraphe + (p_arcsTemporaires ? 2 : 0);
+    if (p_origine >= nbSommets || p_destination >= nbSommets)
         throw logic_error("Graphe::dijkstra(): p_origine ou p_destination n'existe pas");
+    if (p_potentiels && p_potentiels->size() != nbSommets)
+        throw logic_error("Graphe::dijkstra(): il faut un potentiel par sommet");
 
     p_chemin.clear();
 
     if (p_origine == p_destination)
     {
         p_chemin.push_back(p_destination);
+        if (AvecStatistiques) p_statistiques->longueurChemin = 1;
         return 0;
     }
 
-    vector<unsigned int> distance(m_listesAdj.size(), numeric_limits<unsigned int>::max());
-    vector<size_t> predecesseur(m_listesAdj.size(), numeric_limits<size_t>::max());
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    vector<unsigned int> distance(nbSommets, infini);
+    vector<size_t> predecesseur(nbSommets, numeric_limits<size_t>::max());
 
-    //multimap de toutes les distances et du sommet actuel
-    multimap<unsigned int, size_t, std::greater<unsigned int>> mapDistanceNoeud ;
+    //poids de l'arc temporaire de chaque sommet vers la destination (infini si absent)
+    vector<unsigned int> versDestination;
+    if (p_arcsTemporaires)
+    {
+        versDestination.assign(nbSommetsGraphe, infini);
+        for (const auto &arc : p_arcsTemporaires->versDestination)
+        {
+            if (arc.first >= nbSommetsGraphe)
+                throw logic_error("Graphe::dijkstra(): un arc temporaire part d'un sommet inexistant");
+            versDestination[arc.first] = min(versDestination[arc.first], arc.second);
+        }
+        for (const auto &arc : p_arcsTemporaires->depuisOrigine)
+        {
+            if (arc.first >= nbSommetsGraphe)
+                throw logic_error("Graphe::dijkstra(): un arc temporaire mène à un sommet inexistant");
+        }
+    }
+
+    //multimap de toutes les distances (augmentées du potentiel) et du sommet actuel, la plus petite en tête
+    multimap<unsigned long, size_t> mapDistanceNoeud ;
 
     //distance de depart
     distance[p_origine] = 0;
 
     //On met la distance 0 de depart avec le point d'origine
-    mapDistanceNoeud.insert(pair<unsigned int, size_t>(distance[p_origine],p_origine));
+    mapDistanceNoeud.insert(pair<unsigned long, size_t>(distance[p_origine],p_origine));
+    if (AvecStatistiques)
+    {
+        p_statistiques->insertions = 1;
+        p_statistiques->tailleMaxFile = 1;
+    }
+
+    //relâchement de l'arc (sommet, p_voisin)
+    auto relacher = [&](size_t p_sommet, size_t p_voisin, unsigned int p_poids)
+    {
+        //distance totale vers le prochain sommet
+        unsigned int distanceMinimePotentielle = distance[p_sommet] + p_poids;
+
+        //si on trouve une plus petite distance que celle trouvee auparavant (obligatoire a la decouverte du noeud)
+        if (distanceMinimePotentielle < distance[p_voisin])
+        {
+            unsigned long potentiel = p_potentiels ? (*p_potentiels)[p_voisin] : 0;
+            //la destination n'est pas atteignable de ce noeud: inutile de l'explorer
+            if (potentiel == infini) return;
+            //on met la nouvelle distance plus petite dans le prochain sommet
+            distance[p_voisin] = distanceMinimePotentielle;
+            //on met le nouveau predecesseur
+            predecesseur[p_voisin] = p_sommet;
+            //On mettra le nouveau noeud dans la map pour trouver des potentiels plus petits chemins avec la nouvelle valeur
+            mapDistanceNoeud.insert(pair<unsigned long, size_t>(distanceMinimePotentielle + potentiel, p_voisin));
+            if (AvecStatistiques)
+            {
+                ++p_statistiques->arcsRelaches;
+                ++p_statistiques->insertions;
+                p_statistiques->tailleMaxFile = max(p_statistiques->tailleMaxFile, mapDistanceNoeud.size());
+            }
+        }
+    };
 
     size_t sommet;
-    //c'est la distance du sommet actuel plus la distance vers le prochain sommet
-    unsigned int distanceMinimePotentielle;
 
     //Tant que notre map distance Noaud n'est pas vide
     while (!mapDistanceNoeud.empty())
@@ -148,6 +348,7 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
         //on itere sur la map des noeuds, tout en pouvant ajouter des noeuds en faisant de la recursion
         //ici, on sort le sommet de la map avant de peut-etre l'effacer
         sommet = mapDistanceNoeud.begin()->second;
+        unsigned long cle = mapDistanceNoeud.begin()->first;
 
         //si le sommet actuel correspond a la destination, on peut arreter
         if (sommet == p_destination) break;
@@ -155,53 +356,218 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
         //on enleve le noeud actuel de la map, car on sait que ce n'est pas un chemin final,
         //mais l'info est encore dans la variable sommet
         mapDistanceNoeud.erase(mapDistanceNoeud.begin());
+        if (AvecStatistiques) ++p_statistiques->extractions;
 
-        //on itere grace a la liste d'adjacence du noeud actuel
-        //m_listesAdj est un vector<list<Arc>>, donc on itere sur les arcs directs du noeud, non tries
-
-        for (auto sommetAdjacent = m_listesAdj[sommet].begin(); sommetAdjacent != m_listesAdj[sommet].end(); ++sommetAdjacent)
+        //une distance plus petite a été trouvée depuis l'insertion de ce noeud: il a déjà été traité
+        unsigned long potentielSommet = p_potentiels ? (*p_potentiels)[sommet] : 0;
+        if (cle != distance[sommet] + potentielSommet)
         {
-            //distance totale vers le prochain sommet
-            distanceMinimePotentielle = distance[sommet] + sommetAdjacent->poids;
+            if (AvecStatistiques) ++p_statistiques->extractionsPerimees;
+            continue;
+        }
 
-            //si on trouve une plus petite distance que celle trouvee auparavant (obligatoire a la decouverte du noeud)
-            if (distanceMinimePotentielle < distance[sommetAdjacent->destination])
+        //l'origine temporaire n'a que ses arcs temporaires
+        if (sommet >= nbSommetsGraphe)
+        {
+            if (sommet != p_origine) continue;
+            if (AvecStatistiques)
             {
-                //on met la nouvelle distance plus petite dans le prochain sommet
-                distance[sommetAdjacent->destination] = distanceMinimePotentielle;
-                //on met le nouveau predecesseur
-                predecesseur[sommetAdjacent->destination] = sommet;
-                //On mettra le nouveau noeud dans la map pour trouver des potentiels plus petits chemins avec la nouvelle valeur
-                mapDistanceNoeud.insert(pair<unsigned int , size_t>(distanceMinimePotentielle,sommetAdjacent->destination));
+                ++p_statistiques->sommetsTraites;
+                p_statistiques->arcsExamines += p_arcsTemporaires->depuisOrigine.size();
             }
+            for (const auto &arc : p_arcsTemporaires->depuisOrigine) relacher(sommet, arc.first, arc.second);
+            continue;
+        }
+        if (AvecStatistiques)
+        {
+            ++p_statistiques->sommetsTraites;
+            p_statistiques->arcsExamines += m_listesAdj[sommet].size();
+        }
+
+        //on itere grace a la liste d'adjacence du noeud actuel
+        //m_listesAdj est un vector<vector<Arc>>, donc on itere sur les arcs directs du noeud, non tries
+        for (auto sommetAdjacent = m_listesAdj[sommet].begin(); sommetAdjacent != m_listesAdj[sommet].end(); ++sommetAdjacent)
+        {
+            relacher(sommet, sommetAdjacent->destination,
+                     sommetAdjacent->poids + (sommetAdjacent->marque ? p_penaliteMarque : 0));
+        }
+        //puis l'arc temporaire vers la destination, comme s'il était le dernier de la liste d'adjacence
+        if (p_arcsTemporaires && versDestination[sommet] != infini)
+        {
+            if (AvecStatistiques) ++p_statistiques->arcsExamines;
+            relacher(sommet, p_destination, versDestination[sommet]);
         }
     }
 
     //Si pas de solution
-    if (predecesseur[p_destination] == numeric_limits<unsigned int>::max())
+    if (predecesseur[p_destination] == numeric_limits<size_t>::max())
     {
         p_chemin.push_back(p_destination);
         return numeric_limits<unsigned int>::max();
     }
 
-    //On refera le chemin a partir du dernier chemin avec une pile
-    stack<size_t> pileDuChemin;
+    //On refait le chemin à partir de la destination, directement dans p_chemin, puis on l'inverse sur place
     size_t sommetActuel = p_destination;
-    //on met la destination
-    pileDuChemin.push(sommetActuel);
-
-    //tant qu'il y a un predecesseur, on l'ajoute dans la pile
+    p_chemin.push_back(sommetActuel);
     while (predecesseur[sommetActuel] != numeric_limits<size_t>::max())
     {
         sommetActuel = predecesseur[sommetActuel];
-        pileDuChemin.push(sommetActuel);
-    }
-    //on vide la pile dans le chemin dans le bon ordre
-    while (!pileDuChemin.empty())
-    {
-        p_chemin.push_back(pileDuChemin.top());
-        pileDuChemin.pop();
+        p_chemin.push_back(sommetActuel);
     }
+    reverse(p_chemin.begin(), p_chemin.end());
+    if (AvecStatistiques) p_statistiques->longueurChemin = p_chemin.size();
     //on retourne la distance de la destination
     return distance[p_destination];
 }
+
+//! \brief plus court chemin ayant au plus p_contraintes.maxMarques arcs marqués (voir plusCourtChemin())
+//! \brief La recherche porte sur des étiquettes <sommet, distance, arcs marqués>: un sommet peut être traité plusieurs
+//! \brief fois, chaque fois avec moins d'arcs marqués. Les étiquettes sortent de la file par distance (augmentée du
+//! \brief potentiel) croissante, de sorte qu'une étiquette qui n'a pas moins d'arcs marqués que celles déjà traitées à
+//! \brief son sommet est dominée: elle est ignorée. Un sommet est donc traité au plus maxMarques + 1 fois, et la mémoire
+//! \brief ne dépend que du nombre d'étiquettes créées, pas de maxMarques.
+template<bool AvecStatistiques>
+unsigned int Graphe::plusCourtCheminContraint(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+                                              const std::vector<unsigned int> *p_potentiels,
+                                              StatistiquesRecherche *p_statistiques,
+                                              const ArcsTemporaires *p_arcsTemporaires,
+                                              const ContraintesChemin &p_contraintes) const
+{
+    const size_t nbSommetsGraphe = m_listesAdj.size();
+    const size_t nbSommets = nbSommetsGraphe + (p_arcsTemporaires ? 2 : 0);
+    if (p_origine >= nbSommets || p_destination >= nbSommets)
+        throw logic_error("Graphe::dijkstra(): p_origine ou p_destination n'existe pas");
+    if (p_potentiels && p_potentiels->size() != nbSommets)
+        throw logic_error("Graphe::dijkstra(): il faut un potentiel par sommet");
+
+    p_chemin.clear();
+
+    if (p_origine == p_destination)
+    {
+        p_chemin.push_back(p_destination);
+        if (AvecStatistiques) p_statistiques->longueurChemin = 1;
+        return 0;
+    }
+
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    const size_t aucune = numeric_limits<size_t>::max();
+
+    vector<unsigned int> versDestination;
+    if (p_arcsTemporaires)
+    {
+        versDestination.assign(nbSommetsGraphe, infini);
+        for (const auto &arc : p_arcsTemporaires->versDestination)
+        {
+            if (arc.first >= nbSommetsGraphe)
+                throw logic_error("Graphe::dijkstra(): un arc temporaire part d'un sommet inexistant");
+            versDestination[arc.first] = min(versDestination[arc.first], arc.second);
+        }
+        for (const auto &arc : p_arcsTemporaires->depuisOrigine)
+        {
+            if (arc.first >= nbSommetsGraphe)
+                throw logic_error("Graphe::dijkstra(): un arc temporaire mène à un sommet inexistant");
+        }
+    }
+
+    struct Etiquette
+    {
+        size_t sommet;
+        unsigned int distance;
+        unsigned int marques; //arcs marqués du chemin de l'origine à sommet
+        size_t precedente; //l'étiquette du sommet précédent sur ce chemin (aucune pour l'origine)
+    };
+    vector<Etiquette> etiquettes;
+    //marquesTraitees[i]: le moins d'arcs marqués parmi les étiquettes déjà traitées au sommet i (infini: aucune)
+    vector<unsigned int> marquesTraitees(nbSommets, infini);
+    //la plus courte étiquette insérée à chaque sommet, pour éviter d'insérer des étiquettes qu'elle domine
+    vector<unsigned int> distanceInseree(nbSommets, infini);
+    vector<unsigned int> marquesInserees(nbSommets, infini);
+
+    multimap<unsigned long, size_t> file; //<distance augmentée du potentiel, indice de l'étiquette>
+    etiquettes.push_back({p_origine, 0, 0, aucune});
+    file.emplace(0, 0);
+    distanceInseree[p_origine] = 0;
+    marquesInserees[p_origine] = 0;
+    if (AvecStatistiques)
+    {
+        ++p_statistiques->insertions;
+        p_statistiques->tailleMaxFile = max<size_t>(p_statistiques->tailleMaxFile, 1);
+    }
+
+    //crée l'étiquette du voisin atteint de l'étiquette e, à moins qu'elle soit dominée
+    auto relacher = [&](size_t e, size_t p_voisin, unsigned int p_poids, bool p_marque)
+    {
+        unsigned int marques = etiquettes[e].marques + (p_marque ? 1 : 0);
+        if (marques > p_contraintes.maxMarques || marquesTraitees[p_voisin] <= marques) return;
+        unsigned int distance = etiquettes[e].distance + p_poids + (p_marque ? p_contraintes.penaliteMarque : 0);
+        if (distanceInseree[p_voisin] <= distance && marquesInserees[p_voisin] <= marques) return;
+        unsigned long potentiel = p_potentiels ? (*p_potentiels)[p_voisin] : 0;
+        if (potentiel == infini) return;
+        if (distance < distanceInseree[p_voisin])
+        {
+            distanceInseree[p_voisin] = distance;
+            marquesInserees[p_voisin] = marques;
+        }
+        etiquettes.push_back({p_voisin, distance, marques, e});
+        file.emplace(distance + potentiel, etiquettes.size() - 1);
+        if (AvecStatistiques)
+        {
+            ++p_statistiques->arcsRelaches;
+            ++p_statistiques->insertions;
+            p_statistiques->tailleMaxFile = max(p_statistiques->tailleMaxFile, file.size());
+        }
+    };
+
+    size_t arrivee = aucune;
+    while (!file.empty())
+    {
+        size_t e = file.begin()->second;
+        file.erase(file.begin());
+        if (AvecStatistiques) ++p_statistiques->extractions;
+        size_t sommet = etiquettes[e].sommet;
+        if (marquesTraitees[sommet] <= etiquettes[e].marques)
+        {
+            if (AvecStatistiques) ++p_statistiques->extractionsPerimees;
+            continue;
+        }
+        marquesTraitees[sommet] = etiquettes[e].marques;
+        if (sommet == p_destination)
+        {
+            arrivee = e;
+            break;
+        }
+
+        if (sommet >= nbSommetsGraphe)
+        {
+            if (sommet != p_origine) continue;
+            if (AvecStatistiques)
+            {
+                ++p_statistiques->sommetsTraites;
+                p_statistiques->arcsExamines += p_arcsTemporaires->depuisOrigine.size();
+            }
+            for (const auto &arc : p_arcsTemporaires->depuisOrigine) relacher(e, arc.first, arc.second, false);
+            continue;
+        }
+        if (AvecStatistiques)
+        {
+            ++p_statistiques->sommetsTraites;
+            p_statistiques->arcsExamines += m_listesAdj[sommet].size();
+        }
+        for (const Arc &arc : m_listesAdj[sommet]) relacher(e, arc.destination, arc.poids, arc.marque);
+        if (p_arcsTemporaires && versDestination[sommet] != infini)
+        {
+            if (AvecStatistiques) ++p_statistiques->arcsExamines;
+            relacher(e, p_destination, versDestination[sommet], false);
+        }
+    }
+
+    if (arrivee == aucune)
+    {
+        p_chemin.push_back(p_destination);
+        return infini;
+    }
+    for (size_t e = arrivee; e != aucune; e = etiquettes[e].precedente) p_chemin.push_back(etiquettes[e].sommet);
+    reverse(p_chemin.begin(), p_chemin.end());
+    if (AvecStatistiques) p_statistiques->longueurChemin = p_chemin.size();
+    return etiquettes[arrivee].distance;
+}
@@ -18,17 +18,52 @@
 #include <iostream>
 #include <algorithm>
 #include <memory>
+#include <tuple>
+
+#include "metriques.h"
+
+//! \brief compteurs d'une recherche de plus court chemin (voir Graphe::plusCourtChemin())
+struct StatistiquesRecherche
+{
+	size_t sommetsTraites = 0; //sommets extraits de la file avec leur distance définitive
+	size_t arcsExamines = 0; //arcs parcourus à partir des sommets traités
+	size_t arcsRelaches = 0; //arcs ayant amélioré la distance de leur destination
+	size_t insertions = 0; //insertions dans la file de priorité
+	size_t extractions = 0; //extractions de la file de priorité, périmées comprises
+	size_t extractionsPerimees = 0; //extractions d'un sommet dont la distance a été améliorée depuis son insertion
+	size_t tailleMaxFile = 0; //taille maximale atteinte par la file de priorité
+	size_t longueurChemin = 0; //nombre de sommets du chemin trouvé (0 si la destination n'est pas atteignable)
+};
+
+//! \brief contraintes d'une recherche de plus court chemin sur les arcs marqués (voir Graphe::ajouterArcs())
+struct ContraintesChemin
+{
+	unsigned int penaliteMarque = 0; //coût ajouté au poids de chaque arc marqué emprunté
+	unsigned int maxMarques = std::numeric_limits<unsigned int>::max(); //nombre maximal d'arcs marqués d'un chemin
+};
 
 //! \brief  Classe pour graphes orientés pondérés (non négativement) avec listes d'adjacence
 class Graphe {
 public:
 
+	typedef std::vector<std::tuple<size_t, size_t, unsigned int> > TamponArcs; // arcs <i, j, poids> à ajouter
+
+	//! \brief arcs d'un sommet origine et vers un sommet destination qui n'existent que le temps d'une recherche
+	//! \brief (voir plusCourtChemin()); l'origine est le sommet getNbSommets() et la destination, getNbSommets() + 1
+	struct ArcsTemporaires
+	{
+		std::vector<std::pair<size_t, unsigned int> > depuisOrigine; // arcs <j, poids> de l'origine vers j
+		std::vector<std::pair<size_t, unsigned int> > versDestination; // arcs <i, poids> de i vers la destination
+	};
+
 	explicit Graphe(size_t = 0);
 
 	void resize(size_t);
 
 	void ajouterArc(size_t i, size_t j, unsigned int poids);
 
+	void ajouterArcs(const std::vector<TamponArcs> &p_tampons, bool p_marques = false);
+
 	void enleverArc(size_t i, size_t j);
 
 	unsigned int getPoids(size_t i, size_t j) const;
@@ -37,23 +72,54 @@ public:
 
 	size_t getNbArcs() const;
 
+	MemoirePartie memoireUtilisee() const;
+
 	unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
-								 std::vector<size_t> &p_chemin) const;
+								 std::vector<size_t> &p_chemin,
+								 const std::vector<unsigned int> *p_potentiels = nullptr,
+								 StatistiquesRecherche *p_statistiques = nullptr,
+								 const ContraintesChemin *p_contraintes = nullptr) const;
+
+	unsigned int plusCourtChemin(const ArcsTemporaires &p_arcs, std::vector<size_t> &p_chemin,
+								 const std::vector<unsigned int> *p_potentiels = nullptr,
+								 StatistiquesRecherche *p_statistiques = nullptr,
+								 const ContraintesChemin *p_contraintes = nullptr) const;
 
 private:
 
+	template<bool AvecStatistiques>
+	unsigned int plusCourtCheminImpl(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+									 const std::vector<unsigned int> *p_potentiels,
+									 StatistiquesRecherche *p_statistiques,
+									 const ArcsTemporaires *p_arcsTemporaires,
+									 unsigned int p_penaliteMarque) const;
+
+	unsigned int rechercher(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+							const std::vector<unsigned int> *p_potentiels, StatistiquesRecherche *p_statistiques,
+							const ArcsTemporaires *p_arcsTemporaires, const ContraintesChemin *p_contraintes) const;
+
+	size_t nbMarques(const std::vector<size_t> &p_chemin, unsigned int p_penaliteMarque) const;
+
+	template<bool AvecStatistiques>
+	unsigned int plusCourtCheminContraint(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin,
+										  const std::vector<unsigned int> *p_potentiels,
+										  StatistiquesRecherche *p_statistiques,
+										  const ArcsTemporaires *p_arcsTemporaires,
+										  const ContraintesChemin &p_contraintes) const;
+
 	struct Arc {
-		Arc(size_t dest, unsigned int p) :
-				destination(dest), poids(p) {
+		Arc(size_t dest, unsigned int p, bool m = false) :
+				destination(dest), poids(p), marque(m) {
 		}
 
 		size_t destination;
 		unsigned int poids;
+		bool marque; //compté par ContraintesChemin; occupe le remplissage qui suit poids
 
 
     };
 
-	std::vector<std::list<Arc> > m_listesAdj; /*!< les listes d'adjacence */
+	std::vector<std::vector<Arc> > m_listesAdj; /*!< les listes d'adjacence */
 	unsigned long m_nbArcs;
 
     static bool compare_nocase (const Arc& first, const Arc& second);
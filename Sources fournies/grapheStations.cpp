@@ -0,0 +1,298 @@
+//
+// Graphe condensé des stations, dérivé des données GTFS
+//
+
+#include "grapheStations.h"
+#include "parallele.h"
+
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <functional>
+
+using namespace std;
+
+GrapheStations::GrapheStations() : m_debutSuccesseurs(1, 0), m_nbArcs(0)
+{
+}
+
+//! \brief construit le graphe des stations à partir des données GTFS
+//! \param[in] p_gtfs: les données GTFS (dont tous les arrêts ont été ajoutés)
+//! \param[in] p_transferts: les transferts <from_station_id, to_station_id, min_transfer_time> utilisés par le réseau
+//! \param[in] p_nbThreads: le nombre de fils d'exécution à utiliser (0 = nombre de coeurs)
+//! \post un sommet par station de p_gtfs; l'arc (s, t) a le poids minimal des déplacements de s vers t
+//! \post les composantes fortement connexes et le graphe acyclique qui les relie sont calculés
+//! \throws logic_error si un arrêt réfère à une station inexistante
+GrapheStations::GrapheStations(const DonneesGTFS &p_gtfs,
+                               const vector<tuple<unsigned int, unsigned int, unsigned int> > &p_transferts,
+                               unsigned int p_nbThreads)
+        : m_nbArcs(0)
+{
+    const auto &stations = p_gtfs.getStations();
+    m_indiceDeStation.reserve(stations.size());
+    for (const auto &station : stations)
+    {
+        m_indiceDeStation.emplace(station.first, m_indiceDeStation.size());
+    }
+
+    vector<const Voyage *> voyages;
+    voyages.reserve(p_gtfs.getNbVoyages());
+    for (const auto &voyage : p_gtfs.getVoyages())
+    {
+        voyages.push_back(&voyage.second);
+    }
+
+    //chaque fil calcule le poids minimal des déplacements de ses voyages, puis on fusionne
+    unsigned int nbBlocs = nbThreadsEffectifs(p_nbThreads, voyages.size());
+    vector<unordered_map<uint64_t, unsigned int> > poidsParBloc(nbBlocs);
+    executerParBlocs(voyages.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+    {
+        auto &poidsMin = poidsParBloc[p_bloc];
+        for (size_t v = p_debut; v < p_fin; ++v)
+        {
+            const Arret *precedent = nullptr;
+            for (const auto &arret : voyages[v]->getArrets())
+            {
+                if (precedent && precedent->getStationId() != arret->getStationId())
+                {
+                    uint64_t s = getIndice(precedent->getStationId());
+                    uint64_t t = getIndice(arret->getStationId());
+                    unsigned int poids = arret->getHeureArrivee() - precedent->getHeureArrivee();
+                    auto res = poidsMin.emplace((s << 32) | t, poids);
+                    if (!res.second && poids < res.first->second) res.first->second = poids;
+                }
+                precedent = arret.get();
+            }
+        }
+    });
+
+    unordered_map<uint64_t, unsigned int> poidsMin = move(poidsParBloc[0]);
+    for (unsigned int b = 1; b < nbBlocs; ++b)
+    {
+        for (const auto &p : poidsParBloc[b])
+        {
+            auto res = poidsMin.insert(p);
+            if (!res.second && p.second < res.first->second) res.first->second = p.second;
+        }
+    }
+    for (const auto &transfert : p_transferts)
+    {
+        auto s = m_indiceDeStation.find(get<0>(transfert));
+        auto t = m_indiceDeStation.find(get<1>(transfert));
+        if (s == m_indiceDeStation.end() || t == m_indiceDeStation.end() || s->second == t->second) continue;
+        uint64_t cle = ((uint64_t) s->second << 32) | t->second;
+        auto res = poidsMin.emplace(cle, get<2>(transfert));
+        if (!res.second && get<2>(transfert) < res.first->second) res.first->second = get<2>(transfert);
+    }
+
+    //on trie les arcs pour que le graphe ne dépende pas de l'ordre de fusion
+    vector<pair<uint64_t, unsigned int> > arcs(poidsMin.begin(), poidsMin.end());
+    sort(arcs.begin(), arcs.end());
+    m_arcsInverses.resize(m_indiceDeStation.size());
+    vector<vector<size_t> > successeurs(m_indiceDeStation.size());
+    for (const auto &arc : arcs)
+    {
+        size_t s = arc.first >> 32;
+        size_t t = arc.first & 0xFFFFFFFFu;
+        m_arcsInverses[t].emplace_back(s, arc.second);
+        successeurs[s].push_back(t);
+    }
+    m_nbArcs = arcs.size();
+
+    calculerComposantes(successeurs);
+}
+
+//! \brief calcule les composantes fortement connexes (algorithme de Tarjan, sans récursion) et le graphe qui les relie
+//! \param[in] p_successeurs: les listes de successeurs de chaque station
+//! \post les composantes sont numérotées dans l'ordre topologique inverse: chaque arc du graphe des composantes va
+//! d'une composante vers une composante de numéro inférieur
+void GrapheStations::calculerComposantes(const vector<vector<size_t> > &p_successeurs)
+{
+    const unsigned int nonVisite = numeric_limits<unsigned int>::max();
+    size_t n = p_successeurs.size();
+    vector<unsigned int> ordre(n, nonVisite); //l'ordre de première visite de chaque station
+    vector<unsigned int> bas(n); //le plus petit ordre atteignable par l'arbre de parcours et un arc arrière
+    vector<size_t> pile; //les stations visitées dont la composante n'est pas encore connue
+    vector<pair<size_t, size_t> > appels; //<station, prochain successeur à visiter> de la pile d'appels du parcours
+    m_composante.assign(n, nonVisite);
+    unsigned int nbVisites = 0;
+    unsigned int nbComposantes = 0;
+
+    for (size_t racine = 0; racine < n; ++racine)
+    {
+        if (ordre[racine] != nonVisite) continue;
+        ordre[racine] = bas[racine] = nbVisites++;
+        pile.push_back(racine);
+        appels.emplace_back(racine, 0);
+        while (!appels.empty())
+        {
+            size_t s = appels.back().first;
+            if (appels.back().second < p_successeurs[s].size())
+            {
+                size_t t = p_successeurs[s][appels.back().second++];
+                if (ordre[t] == nonVisite)
+                {
+                    ordre[t] = bas[t] = nbVisites++;
+                    pile.push_back(t);
+                    appels.emplace_back(t, 0);
+                }
+                else if (m_composante[t] == nonVisite) bas[s] = min(bas[s], ordre[t]); //t est encore sur la pile
+                continue;
+            }
+            appels.pop_back();
+            if (!appels.empty()) bas[appels.back().first] = min(bas[appels.back().first], bas[s]);
+            if (bas[s] == ordre[s])
+            {
+                size_t t;
+                do
+                {
+                    t = pile.back();
+                    pile.pop_back();
+                    m_composante[t] = nbComposantes;
+                } while (t != s);
+                ++nbComposantes;
+            }
+        }
+    }
+
+    //les arcs entre composantes distinctes, sans doublons, regroupés par composante de départ
+    vector<pair<unsigned int, unsigned int> > arcs;
+    for (size_t s = 0; s < n; ++s)
+    {
+        for (size_t t : p_successeurs[s])
+        {
+            if (m_composante[s] != m_composante[t]) arcs.emplace_back(m_composante[s], m_composante[t]);
+        }
+    }
+    sort(arcs.begin(), arcs.end());
+    arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+    m_debutSuccesseurs.assign(nbComposantes + 1, 0);
+    m_successeursComposantes.clear();
+    m_successeursComposantes.reserve(arcs.size());
+    for (const auto &arc : arcs)
+    {
+        ++m_debutSuccesseurs[arc.first + 1];
+        m_successeursComposantes.push_back(arc.second);
+    }
+    for (unsigned int c = 0; c < nbComposantes; ++c) m_debutSuccesseurs[c + 1] += m_debutSuccesseurs[c];
+}
+
+size_t GrapheStations::getNbStations() const
+{
+    return m_arcsInverses.size();
+}
+
+size_t GrapheStations::getNbArcs() const
+{
+    return m_nbArcs;
+}
+
+//! \brief retourne la mémoire allouée par l'index des stations, les arcs inverses et le graphe des composantes
+MemoirePartie GrapheStations::memoireUtilisee() const
+{
+    MemoirePartie memoire;
+    memoire.partie = "grapheStations";
+    ajouterMemoireTable(memoire, m_indiceDeStation);
+    ajouterMemoire(memoire, m_arcsInverses);
+    for (const auto &arcs : m_arcsInverses) ajouterMemoire(memoire, arcs);
+    ajouterMemoire(memoire, m_composante);
+    ajouterMemoire(memoire, m_debutSuccesseurs);
+    ajouterMemoire(memoire, m_successeursComposantes);
+    return memoire;
+}
+
+//! \brief retourne le sommet associé à une station
+//! \throws logic_error si la station n'existe pas
+size_t GrapheStations::getIndice(unsigned int p_stationId) const
+{
+    auto itr = m_indiceDeStation.find(p_stationId);
+    if (itr == m_indiceDeStation.end())
+        throw logic_error("GrapheStations::getIndice(): station inexistante");
+    return itr->second;
+}
+
+//! \brief indique si au moins une des stations cibles est atteignable à partir d'une des stations sources
+//! \brief Il s'agit d'une condition nécessaire (les heures de passage ne sont pas considérées): une réponse négative
+//! \brief garantit que la destination n'est pas atteignable dans le réseau GTFS
+//! \param[in] p_sources: les sommets (indices) des stations de départ
+//! \param[in] p_cibles: les sommets (indices) des stations d'arrivée
+bool GrapheStations::estAtteignable(const vector<size_t> &p_sources, const vector<size_t> &p_cibles) const
+{
+    if (p_sources.empty() || p_cibles.empty()) return false;
+    size_t nbComposantes = m_debutSuccesseurs.size() - 1;
+    vector<char> estCible(nbComposantes, 0);
+    unsigned int cibleMin = numeric_limits<unsigned int>::max();
+    for (size_t t : p_cibles)
+    {
+        unsigned int c = m_composante.at(t);
+        estCible[c] = 1;
+        cibleMin = min(cibleMin, c);
+    }
+
+    //parcours du graphe des composantes; puisque ses arcs vont vers des numéros inférieurs, une composante de numéro
+    //inférieur à cibleMin ne peut mener à une cible
+    vector<char> vues(nbComposantes, 0);
+    vector<unsigned int> file;
+    for (size_t s : p_sources)
+    {
+        unsigned int c = m_composante.at(s);
+        if (estCible[c]) return true;
+        if (c > cibleMin && !vues[c])
+        {
+            vues[c] = 1;
+            file.push_back(c);
+        }
+    }
+    for (size_t k = 0; k < file.size(); ++k)
+    {
+        for (size_t a = m_debutSuccesseurs[file[k]]; a < m_debutSuccesseurs[file[k] + 1]; ++a)
+        {
+            unsigned int c = m_successeursComposantes[a];
+            if (estCible[c]) return true;
+            if (c > cibleMin && !vues[c])
+            {
+                vues[c] = 1;
+                file.push_back(c);
+            }
+        }
+    }
+    return false;
+}
+
+//! \brief calcule pour chaque station une borne inférieure du temps nécessaire pour atteindre la destination
+//! \brief (algorithme de Dijkstra sur le graphe inverse, à partir de toutes les cibles simultanément)
+//! \param[in] p_cibles: paires <sommet de la station, temps pour aller de cette station à la destination>
+//! \param[out] p_bornes: p_bornes[s] est la borne de la station s (= numeric_limits<unsigned int>::max() si
+//! la destination n'est pas atteignable de s)
+void GrapheStations::bornesInferieures(const vector<pair<size_t, unsigned int> > &p_cibles,
+                                       vector<unsigned int> &p_bornes) const
+{
+    const unsigned int infini = numeric_limits<unsigned int>::max();
+    p_bornes.assign(m_arcsInverses.size(), infini);
+
+    typedef pair<unsigned int, size_t> Entree;
+    priority_queue<Entree, vector<Entree>, greater<Entree> > file;
+    for (const auto &cible : p_cibles)
+    {
+        if (cible.second < p_bornes.at(cible.first))
+        {
+            p_bornes[cible.first] = cible.second;
+            file.emplace(cible.second, cible.first);
+        }
+    }
+    while (!file.empty())
+    {
+        Entree e = file.top();
+        file.pop();
+        if (e.first != p_bornes[e.second]) continue; //entrée périmée
+        for (const auto &arc : m_arcsInverses[e.second])
+        {
+            unsigned int d = e.first + arc.poids;
+            if (d < p_bornes[arc.destination])
+            {
+                p_bornes[arc.destination] = d;
+                file.emplace(d, arc.destination);
+            }
+        }
+    }
+}
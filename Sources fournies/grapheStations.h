@@ -0,0 +1,64 @@
+//
+// Graphe condensé des stations, dérivé des données GTFS
+//
+
+#ifndef RTC_GRAPHESTATIONS_H
+#define RTC_GRAPHESTATIONS_H
+
+#include <vector>
+#include <tuple>
+#include <unordered_map>
+#include <cstdint>
+
+#include "DonneesGTFS.h"
+
+/*!
+ * \class GrapheStations
+ * \brief Graphe orienté possédant un sommet par station.
+ * Un arc (s, t) existe si un voyage passe de s à t ou si un transfert permet d'aller de s à t;
+ * son poids est le plus petit temps (en secondes) observé pour ce déplacement.
+ * Puisque tout arc du graphe du réseau GTFS a un poids supérieur ou égal à l'arc correspondant de ce graphe,
+ * la distance vers la destination dans ce graphe est une borne inférieure admissible (et cohérente) pour le réseau GTFS.
+ * L'atteignabilité est vérifiée sur le graphe acyclique des composantes fortement connexes, de taille linéaire en celle
+ * du graphe, plutôt que sur une table de toutes les paires de stations.
+ */
+class GrapheStations
+{
+
+public:
+    GrapheStations();
+    GrapheStations(const DonneesGTFS &, const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &,
+                   unsigned int p_nbThreads = 0);
+
+    size_t getNbStations() const;
+    size_t getNbArcs() const;
+    MemoirePartie memoireUtilisee() const;
+    size_t getIndice(unsigned int p_stationId) const;
+    bool estAtteignable(const std::vector<size_t> &p_sources, const std::vector<size_t> &p_cibles) const;
+    void bornesInferieures(const std::vector<std::pair<size_t, unsigned int> > &p_cibles,
+                           std::vector<unsigned int> &p_bornes) const;
+
+private:
+    struct Arc
+    {
+        Arc(size_t dest, unsigned int p) :
+                destination(dest), poids(p)
+        {
+        }
+
+        size_t destination;
+        unsigned int poids;
+    };
+
+    std::unordered_map<unsigned int, size_t> m_indiceDeStation; //m_indiceDeStation[id] est le sommet de la station id
+    std::vector<std::vector<Arc> > m_arcsInverses; //m_arcsInverses[t] contient les arcs (s, t), avec s comme destination
+    std::vector<unsigned int> m_composante; //m_composante[s] est la composante fortement connexe de la station s
+    std::vector<size_t> m_debutSuccesseurs; //les successeurs de la composante c sont dans [m_debutSuccesseurs[c], [c + 1])
+    std::vector<unsigned int> m_successeursComposantes; //les arcs du graphe des composantes (acyclique)
+    size_t m_nbArcs;
+
+    void calculerComposantes(const std::vector<std::vector<size_t> > &p_successeurs);
+};
+
+
+#endif //RTC_GRAPHESTATIONS_H
@@ -0,0 +1,77 @@
+//
+// Index spatial des stations (grille uniforme sur la sphère unité)
+//
+
+#include "grilleStations.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+GrilleStations::GrilleStations() : m_coords(nullptr), m_rayon(0), m_cote(1), m_seuil(0)
+{
+}
+
+//! \brief construit la grille des stations pour un rayon de recherche donné
+//! \param[in] p_coords: les positions des stations; elles doivent survivre à la grille et ne pas être modifiées
+//! \param[in] p_rayon: le rayon de recherche, en km
+//! \throws logic_error si le rayon n'est pas positif
+GrilleStations::GrilleStations(const CoordonneesStations &p_coords, double p_rayon)
+        : m_coords(&p_coords), m_rayon(p_rayon)
+{
+    if (!(p_rayon > 0)) throw logic_error("GrilleStations::GrilleStations(): le rayon doit être positif");
+    double demiAngle = min(p_rayon / (2 * Coordonnees::rayonTerre), 3.14159265358979323846 / 2);
+    double corde = 2 * sin(demiAngle);
+    m_seuil = corde * corde * (1 + 1e-12); //même tolérance que DonneesGTFS::stationsDansRayon()
+    m_cote = max(corde, 2.0 / (1 << 20)); //au plus 2^20 cubes par axe, pour que la clé tienne sur 64 bits
+    for (size_t s = 0; s < p_coords.ids.size(); ++s)
+    {
+        m_cellules[cle(coordonneeCellule(p_coords.x[s]), coordonneeCellule(p_coords.y[s]),
+                       coordonneeCellule(p_coords.z[s]))].push_back(s);
+    }
+}
+
+double GrilleStations::getRayon() const
+{
+    return m_rayon;
+}
+
+int64_t GrilleStations::coordonneeCellule(double p_valeur) const
+{
+    return (int64_t) floor(p_valeur / m_cote);
+}
+
+uint64_t GrilleStations::cle(int64_t p_i, int64_t p_j, int64_t p_k)
+{
+    const int64_t decalage = int64_t(1) << 20; //les coordonnées de cellule sont dans [-2^19 - 1, 2^19 + 1]
+    return ((uint64_t) (p_i + decalage) << 42) | ((uint64_t) (p_j + decalage) << 21) | (uint64_t) (p_k + decalage);
+}
+
+//! \brief trouve les stations à au plus getRayon() km d'un point
+//! \param[in] p_x, p_y, p_z: le vecteur unitaire du point (voir Coordonnees::getX())
+//! \param[out] p_stations: les indices (dans CoordonneesStations) des stations dans le rayon, en ordre croissant
+//! \post comme pour DonneesGTFS::stationsDansRayon(), une station à la frontière (à 1e-12 près) peut être incluse
+void GrilleStations::stationsProches(double p_x, double p_y, double p_z, vector<size_t> &p_stations) const
+{
+    p_stations.clear();
+    if (!m_coords) return;
+    int64_t ci = coordonneeCellule(p_x), cj = coordonneeCellule(p_y), ck = coordonneeCellule(p_z);
+    for (int64_t i = ci - 1; i <= ci + 1; ++i)
+    {
+        for (int64_t j = cj - 1; j <= cj + 1; ++j)
+        {
+            for (int64_t k = ck - 1; k <= ck + 1; ++k)
+            {
+                auto itr = m_cellules.find(cle(i, j, k));
+                if (itr == m_cellules.end()) continue;
+                for (size_t s : itr->second)
+                {
+                    double dx = m_coords->x[s] - p_x, dy = m_coords->y[s] - p_y, dz = m_coords->z[s] - p_z;
+                    if (dx * dx + dy * dy + dz * dz <= m_seuil) p_stations.push_back(s);
+                }
+            }
+        }
+    }
+    sort(p_stations.begin(), p_stations.end());
+}
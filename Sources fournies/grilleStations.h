@@ -0,0 +1,45 @@
+//
+// Index spatial des stations (grille uniforme sur la sphère unité)
+//
+
+#ifndef RTC_GRILLESTATIONS_H
+#define RTC_GRILLESTATIONS_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "DonneesGTFS.h"
+
+/*!
+ * \class GrilleStations
+ * \brief Index spatial permettant de trouver les stations situées à une distance donnée d'un point.
+ * Les stations sont réparties dans une grille de cubes couvrant leurs vecteurs unitaires (voir CoordonneesStations);
+ * le côté d'un cube est la corde correspondant au rayon de recherche, de sorte que toute station dans le rayon se trouve
+ * dans l'un des 27 cubes entourant celui du point. La recherche coûte donc un temps proportionnel au nombre de stations
+ * voisines plutôt qu'au nombre total de stations.
+ */
+class GrilleStations
+{
+
+public:
+    GrilleStations();
+    GrilleStations(const CoordonneesStations &p_coords, double p_rayon);
+
+    double getRayon() const;
+    void stationsProches(double p_x, double p_y, double p_z, std::vector<size_t> &p_stations) const;
+
+private:
+    const CoordonneesStations *m_coords;
+    double m_rayon; //en km
+    double m_cote; //côté d'un cube, sur la sphère unité
+    double m_seuil; //corde au carré correspondant à m_rayon
+    std::unordered_map<uint64_t, std::vector<size_t> > m_cellules; //indices (dans m_coords) des stations de chaque cube
+
+    int64_t coordonneeCellule(double p_valeur) const;
+    static uint64_t cle(int64_t p_i, int64_t p_j, int64_t p_k);
+};
+
+
+#endif //RTC_GRILLESTATIONS_H
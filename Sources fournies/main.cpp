@@ -4,21 +4,66 @@
 
 #include <iostream>
 #include <random>
+#include <cmath>
+#include <algorithm>
 
 #include "DonneesGTFS.h"
 #include "ReseauGTFS.h"
 
 using namespace std;
 
-int main()
+//retourne le centile p_p (entre 0 et 1) de p_valeurs, par la méthode du rang le plus proche
+template<typename T>
+static T centile(vector<T> p_valeurs, double p_p)
+{
+    if (p_valeurs.empty()) return T();
+    size_t rang = (size_t) ceil(p_p * p_valeurs.size());
+    if (rang > 0) --rang;
+    nth_element(p_valeurs.begin(), p_valeurs.begin() + rang, p_valeurs.end());
+    return p_valeurs[rang];
+}
+
+//affiche les centiles 50, 95 et 99 et le maximum d'une mesure
+template<typename T>
+static void afficherCentiles(const string &p_nom, const vector<T> &p_valeurs)
+{
+    cout << "  " << p_nom << ": " << centile(p_valeurs, 0.50) << " / " << centile(p_valeurs, 0.95) << " / "
+         << centile(p_valeurs, 0.99) << " / " << centile(p_valeurs, 1.0) << endl;
+}
+
+//affiche l'empreinte mémoire estimée d'un objet, par partie, et la mémoire mesurée si les allocations sont suivies
+static void afficherMemoire(const string &p_nom, const MemoireUtilisee &p_memoire, size_t p_octetsMesures)
+{
+    cout << "Mémoire " << p_nom << " = " << p_memoire.totalOctets() / 1024 << " ko en " << p_memoire.totalAllocations()
+         << " allocations";
+    if (allocationsSuivies()) cout << " (mesurée: " << p_octetsMesures / 1024 << " ko)";
+    cout << endl;
+    for (const auto &p : p_memoire.parties)
+        cout << "  " << p.partie << ": " << p.octets / 1024 << " ko (" << p.allocations << " allocations)" << endl;
+}
+
+//usage: ProjetAlgo1 [--metriques fichier.json]
+//avec --metriques, les mesures du chargement et de la construction du réseau sont écrites en JSON dans fichier.json;
+//les allocations n'y sont comptées que si le programme est compilé avec SUIVI_MEMOIRE (cmake -DSUIVI_MEMOIRE=ON)
+int main(int argc, char *argv[])
 {
     const std::string chemin_dossier = "../RTC-1aout-30nov";
+    std::string fichierMetriques;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--metriques" && i + 1 < argc) fichierMetriques = argv[++i];
+        else throw logic_error("main(): argument invalide (usage: [--metriques fichier.json])");
+    }
+    if (!fichierMetriques.empty() && !allocationsSuivies())
+        cerr << "Les allocations ne sont pas comptées (null dans " << fichierMetriques
+             << "): compiler avec -DSUIVI_MEMOIRE=ON pour les mesurer" << endl;
     Date today(2018, 9, 21);
     Heure now1(7, 30, 0);
 //    Date today; //Le constructeur par défaut initialise la date à aujourd'hui
 //    Heure now1; //Le constructeur par défaut initialise l'heure à maintenant
     Heure now2 = now1.add_secondes(86400); //on désire obtenir tous les arrêts du reste de la journée
 
+    size_t octetsAvant = octetsAlloues();
     clock_t begin = clock();
     DonneesGTFS donnees_rtc(today, now1, now2);
     donnees_rtc.ajouterLignes(chemin_dossier + "/routes.txt");
@@ -38,12 +83,39 @@ int main()
     cout << "Nombre de transferts = " << donnees_rtc.getNbTransferts() << endl;
     cout << "Nombres de voyages = " << donnees_rtc.getNbVoyages() << endl;
     cout << "Nombre d'arrêts = " << donnees_rtc.getNbArrets() << endl;
+    const CompteursArrets &compteurs = donnees_rtc.getCompteursArrets();
+    cout << "Lignes de stop_times.txt acceptées = " << compteurs.acceptees << ", rejetées (voyage absent) = "
+         << compteurs.rejeteesVoyage << ", rejetées (hors intervalle) = " << compteurs.rejeteesIntervalle << endl;
+    MemoireUtilisee memoireDonnees = donnees_rtc.memoireUtilisee();
+    afficherMemoire("des données", memoireDonnees, octetsAlloues() - octetsAvant);
+    octetsAvant = octetsAlloues();
     begin = clock();
     ReseauGTFS reseau_rtc(donnees_rtc);
     end = clock();
+    size_t octetsReseau = octetsAlloues() - octetsAvant;
     cout << "Le nombre d'arcs (sans le point origine et destination) est = " << reseau_rtc.getNbArcs() << endl;
+    cout << "Arcs de transfert = " << reseau_rtc.getNbArcsTransferts() << " (transferts à pied générés = "
+         << reseau_rtc.getNbTransfertsMarche() << ")" << endl;
     cout << "Graphe (sans le point source et destination) a été produit en " << double(end - begin) / CLOCKS_PER_SEC
-         << " secondes" << endl << endl;
+         << " secondes" << endl;
+    MemoireUtilisee memoireReseau = reseau_rtc.memoireUtilisee();
+    afficherMemoire("du réseau", memoireReseau, octetsReseau);
+    cout << endl;
+
+    if (!fichierMetriques.empty())
+    {
+        ofstream flux(fichierMetriques);
+        if (!flux) throw logic_error("main(): impossible d'écrire " + fichierMetriques);
+        flux << "{\"chargement\": ";
+        ecrireJSON(flux, donnees_rtc.getMetriques());
+        flux << ", \"construction\": ";
+        ecrireJSON(flux, reseau_rtc.getMetriques());
+        flux << ", \"memoireDonnees\": ";
+        ecrireJSON(flux, memoireDonnees);
+        flux << ", \"memoireReseau\": ";
+        ecrireJSON(flux, memoireReseau);
+        flux << "}" << endl;
+    }
 
     cout << "==========================================" << endl;
     cout << "           début de la simulation         " << endl;
@@ -66,10 +138,14 @@ int main()
     }
 
     bool afficherItineraire = true;
+    const ParametresRecherche parametres; //la marche permise de chaque requête: l'origine et la destination en sont éloignées
     const unsigned int nbDeTests = 100; //nombre de tests à effectuer
     long moy_tempsExecution = 0;
 
     unsigned int nbDeTestsComptabilises = 0;
+    vector<long> temps;
+    vector<size_t> sommetsTraites, arcsExamines, arcsRelaches, insertions, extractions, extractionsPerimees,
+            tailleMaxFile, longueurChemin;
     //on comptabilise un test seulement si la destination est atteignable et différente de l'origine
     for (unsigned int i = 0; i < nbDeTests; ++i)
     {
@@ -81,7 +157,7 @@ int main()
         Coordonnees pointDestination = pointOrigine;
 
         while (stationIdOrigine == stationIdDestination ||
-               pointOrigine - pointDestination <= 2.1 * reseau_rtc.getDistMaxMarche())
+               pointOrigine - pointDestination <= 2.1 * parametres.distanceMaxMarche)
         {
             temp = distribution(generator);
             stationIdDestination = station_ids.at(temp);
@@ -92,10 +168,13 @@ int main()
         cout << "station du point destination = " << stations.at(stationIdDestination) << endl;
         cout << "distance = " << pointOrigine - pointDestination << " kilomètres" << endl;
 
-        reseau_rtc.ajouterArcsOrigineDestination(donnees_rtc, pointOrigine, pointDestination);
+        reseau_rtc.ajouterArcsOrigineDestination(donnees_rtc, pointOrigine, pointDestination, donnees_rtc.getTempsDebut(),
+                                                 parametres);
 
         long tempsExecution(0);
-        unsigned int tempsDuTrajet = reseau_rtc.itineraire(donnees_rtc, afficherItineraire, tempsExecution);
+        StatistiquesRecherche statistiques;
+        unsigned int tempsDuTrajet = reseau_rtc.itineraire(donnees_rtc, afficherItineraire, tempsExecution,
+                                                           &statistiques);
         if (tempsDuTrajet == numeric_limits<unsigned int>::max())
         {
             cout << "impossible d'atteindre la destination. On passe au test suivant." << endl;
@@ -108,6 +187,15 @@ int main()
         {
             moy_tempsExecution += tempsExecution;
             ++nbDeTestsComptabilises;
+            temps.push_back(tempsExecution);
+            sommetsTraites.push_back(statistiques.sommetsTraites);
+            arcsExamines.push_back(statistiques.arcsExamines);
+            arcsRelaches.push_back(statistiques.arcsRelaches);
+            insertions.push_back(statistiques.insertions);
+            extractions.push_back(statistiques.extractions);
+            extractionsPerimees.push_back(statistiques.extractionsPerimees);
+            tailleMaxFile.push_back(statistiques.tailleMaxFile);
+            longueurChemin.push_back(statistiques.longueurChemin);
             cout << "Temps d'exécution de l'algorithme de plus court chemin: " << tempsExecution
                  << " microsecondes" << endl;
 
@@ -119,5 +207,17 @@ int main()
     cout << endl << "La moyenne du temps d'exécution sur " << nbDeTests << " itinéraires est de "
          << (double)moy_tempsExecution / (double)nbDeTestsComptabilises << " microsecondes" << endl;
 
+    cout << endl << "Statistiques des recherches sur " << nbDeTestsComptabilises
+         << " itinéraires (centiles 50 / 95 / 99 / maximum):" << endl;
+    afficherCentiles("temps d'exécution (microsecondes)", temps);
+    afficherCentiles("sommets traités", sommetsTraites);
+    afficherCentiles("arcs examinés", arcsExamines);
+    afficherCentiles("arcs relâchés", arcsRelaches);
+    afficherCentiles("insertions dans la file", insertions);
+    afficherCentiles("extractions de la file", extractions);
+    afficherCentiles("extractions périmées", extractionsPerimees);
+    afficherCentiles("taille maximale de la file", tailleMaxFile);
+    afficherCentiles("longueur du chemin (sommets)", longueurChemin);
+
     return 0;
 }
\ No newline at end of file
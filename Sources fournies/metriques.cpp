@@ -0,0 +1,184 @@
+//
+// Mesures (temps, volumes, allocations) du chargement des données GTFS et de la construction du réseau
+//
+
+#include "metriques.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+namespace
+{
+    atomic<size_t> nbAllocations(0);
+    atomic<size_t> nbOctets(0);
+}
+
+#ifdef SUIVI_MEMOIRE
+//Remplacement des opérateurs globaux: chaque allocation est comptée et sa taille est conservée dans un entête placé
+//devant le bloc, pour suivre les octets alloués (les autres formes de new et delete, dont new[] et les versions
+//nothrow, délèguent à celles-ci)
+namespace
+{
+    const size_t tailleEntete = alignof(max_align_t); //préserve l'alignement du bloc retourné
+}
+
+void *operator new(size_t p_taille)
+{
+    nbAllocations.fetch_add(1, memory_order_relaxed);
+    nbOctets.fetch_add(p_taille, memory_order_relaxed);
+    char *p = static_cast<char *>(malloc(p_taille + tailleEntete));
+    if (!p) throw bad_alloc();
+    *reinterpret_cast<size_t *>(p) = p_taille;
+    return p + tailleEntete;
+}
+
+void operator delete(void *p_ptr) noexcept
+{
+    if (!p_ptr) return;
+    char *p = static_cast<char *>(p_ptr) - tailleEntete;
+    nbOctets.fetch_sub(*reinterpret_cast<size_t *>(p), memory_order_relaxed);
+    free(p);
+}
+
+void operator delete(void *p_ptr, size_t) noexcept
+{
+    operator delete(p_ptr);
+}
+#endif
+
+//! \brief indique si les allocations dynamiques sont comptées (programme compilé avec SUIVI_MEMOIRE)
+bool allocationsSuivies()
+{
+#ifdef SUIVI_MEMOIRE
+    return true;
+#else
+    return false;
+#endif
+}
+
+//! \brief retourne le nombre d'allocations dynamiques effectuées depuis le début du programme (0 si elles ne sont pas suivies)
+size_t compteurAllocations()
+{
+    return nbAllocations.load(memory_order_relaxed);
+}
+
+//! \brief retourne le nombre d'octets alloués dynamiquement et non libérés (0 si les allocations ne sont pas suivies)
+size_t octetsAlloues()
+{
+    return nbOctets.load(memory_order_relaxed);
+}
+
+//! \brief retourne la somme des octets de toutes les parties
+size_t MemoireUtilisee::totalOctets() const
+{
+    size_t total = 0;
+    for (const auto &p : parties) total += p.octets;
+    return total;
+}
+
+//! \brief retourne la somme des allocations de toutes les parties
+size_t MemoireUtilisee::totalAllocations() const
+{
+    size_t total = 0;
+    for (const auto &p : parties) total += p.allocations;
+    return total;
+}
+
+Chronometre::Chronometre() : m_debut(chrono::steady_clock::now()), m_allocationsDebut(compteurAllocations())
+{
+}
+
+//! \brief retourne le temps écoulé depuis la création, en millisecondes
+double Chronometre::ecouleMs() const
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - m_debut).count();
+}
+
+//! \brief retourne le nombre d'allocations dynamiques (de tous les fils d'exécution) effectuées depuis la création
+size_t Chronometre::allocations() const
+{
+    return compteurAllocations() - m_allocationsDebut;
+}
+
+//! \brief écrit une chaîne JSON (entre guillemets, caractères spéciaux échappés)
+void ecrireChaineJSON(ostream &p_flux, const string &p_chaine)
+{
+    p_flux << '"';
+    for (unsigned char c : p_chaine)
+    {
+        if (c == '"' || c == '\\') p_flux << '\\' << c;
+        else if (c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            p_flux << code;
+        }
+        else p_flux << c;
+    }
+    p_flux << '"';
+}
+
+//écrit le nombre d'allocations, ou null si elles ne sont pas suivies
+static void ecrireAllocations(ostream &p_flux, size_t p_allocations)
+{
+    if (allocationsSuivies()) p_flux << p_allocations;
+    else p_flux << "null";
+}
+
+//! \brief écrit les mesures du chargement au format JSON (un objet)
+void ecrireJSON(ostream &p_flux, const MetriquesDonnees &p_metriques)
+{
+    p_flux << "{\"fichiers\": [";
+    for (size_t i = 0; i < p_metriques.fichiers.size(); ++i)
+    {
+        const MetriquesFichier &f = p_metriques.fichiers[i];
+        p_flux << (i ? ", " : "") << "{\"fichier\": ";
+        ecrireChaineJSON(p_flux, f.fichier);
+        p_flux << ", \"octetsLus\": " << f.octetsLus << ", \"lignesLues\": " << f.lignesLues
+               << ", \"lignesAcceptees\": " << f.lignesAcceptees << ", \"allocations\": ";
+        ecrireAllocations(p_flux, f.allocations);
+        p_flux << ", \"tempsMs\": " << f.tempsMs << "}";
+    }
+    p_flux << "], \"nbStations\": " << p_metriques.nbStations << ", \"nbVoyages\": " << p_metriques.nbVoyages
+           << ", \"nbArrets\": " << p_metriques.nbArrets << ", \"nbTransferts\": " << p_metriques.nbTransferts << "}";
+}
+
+//! \brief écrit les mesures de la construction du réseau au format JSON (un objet)
+void ecrireJSON(ostream &p_flux, const MetriquesReseau &p_metriques)
+{
+    p_flux << "{\"etapes\": [";
+    for (size_t i = 0; i < p_metriques.etapes.size(); ++i)
+    {
+        const MetriquesEtape &e = p_metriques.etapes[i];
+        p_flux << (i ? ", " : "") << "{\"etape\": ";
+        ecrireChaineJSON(p_flux, e.etape);
+        p_flux << ", \"arcsAjoutes\": " << e.arcsAjoutes << ", \"allocations\": ";
+        ecrireAllocations(p_flux, e.allocations);
+        p_flux << ", \"tempsMs\": " << e.tempsMs << "}";
+    }
+    p_flux << "], \"nbSommets\": " << p_metriques.nbSommets << ", \"nbArcs\": " << p_metriques.nbArcs
+           << ", \"arcsVoyages\": " << p_metriques.arcsVoyages << ", \"arcsAttente\": " << p_metriques.arcsAttente
+           << ", \"arcsTransferts\": " << p_metriques.arcsTransferts
+           << ", \"transfertsMarche\": " << p_metriques.transfertsMarche
+           << ", \"raccourcisPietons\": " << p_metriques.raccourcisPietons
+           << ", \"arcsStations\": " << p_metriques.arcsStations << ", \"tempsMs\": " << p_metriques.tempsMs << "}";
+}
+
+//! \brief écrit l'empreinte mémoire d'un objet au format JSON (un objet)
+void ecrireJSON(ostream &p_flux, const MemoireUtilisee &p_memoire)
+{
+    p_flux << "{\"parties\": [";
+    for (size_t i = 0; i < p_memoire.parties.size(); ++i)
+    {
+        const MemoirePartie &p = p_memoire.parties[i];
+        p_flux << (i ? ", " : "") << "{\"partie\": ";
+        ecrireChaineJSON(p_flux, p.partie);
+        p_flux << ", \"octets\": " << p.octets << ", \"allocations\": " << p.allocations << "}";
+    }
+    p_flux << "], \"totalOctets\": " << p_memoire.totalOctets()
+           << ", \"totalAllocations\": " << p_memoire.totalAllocations() << "}";
+}
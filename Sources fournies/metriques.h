@@ -0,0 +1,152 @@
+//
+// Mesures (temps, volumes, allocations) du chargement des données GTFS et de la construction du réseau
+//
+
+#ifndef RTC_METRIQUES_H
+#define RTC_METRIQUES_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+//! \brief mesures de la lecture d'un fichier GTFS (voir DonneesGTFS::getMetriques())
+struct MetriquesFichier
+{
+    std::string fichier; //le nom du fichier lu
+    size_t octetsLus = 0; //octets lus, fins de ligne comprises
+    size_t lignesLues = 0; //lignes de données lues (sans l'entête)
+    size_t lignesAcceptees = 0; //lignes ayant produit un objet (ligne, station, service, voyage, arrêt ou transfert)
+    size_t allocations = 0; //allocations dynamiques effectuées pendant la lecture (si allocationsSuivies())
+    double tempsMs = 0; //temps écoulé (horloge murale), en millisecondes
+};
+
+//! \brief mesures du chargement des données GTFS, un élément par fichier lu, dans l'ordre de lecture
+struct MetriquesDonnees
+{
+    std::vector<MetriquesFichier> fichiers;
+    size_t nbStations = 0; //stations conservées (ayant au moins un arrêt une fois les arrêts ajoutés)
+    size_t nbVoyages = 0;
+    size_t nbArrets = 0;
+    size_t nbTransferts = 0;
+};
+
+//! \brief mesures d'une étape de la construction du réseau (voir ReseauGTFS::getMetriques())
+struct MetriquesEtape
+{
+    std::string etape; //le nom de l'étape
+    size_t arcsAjoutes = 0; //arcs ajoutés au graphe par cette étape
+    size_t allocations = 0; //allocations dynamiques effectuées pendant l'étape (si allocationsSuivies())
+    double tempsMs = 0; //temps écoulé (horloge murale), en millisecondes
+};
+
+//! \brief mesures de la construction du réseau GTFS
+struct MetriquesReseau
+{
+    std::vector<MetriquesEtape> etapes; //dans l'ordre d'exécution
+    size_t nbSommets = 0;
+    size_t nbArcs = 0;
+    size_t arcsVoyages = 0; //arcs entre arrêts successifs d'un même voyage
+    size_t arcsAttente = 0; //arcs des chaînes d'attente (ModeleTransferts::CHAINES_ATTENTE)
+    size_t arcsTransferts = 0; //arcs de transfert entre stations (ou vers une chaîne d'attente)
+    size_t transfertsMarche = 0; //transferts à pied générés entre stations voisines
+    size_t raccourcisPietons = 0; //raccourcis du réseau piétonnier
+    size_t arcsStations = 0; //arcs du graphe condensé des stations
+    double tempsMs = 0; //temps total de la construction
+};
+
+//! \brief mémoire allouée dynamiquement par une partie d'un objet (voir DonneesGTFS::memoireUtilisee())
+struct MemoirePartie
+{
+    std::string partie; //le nom de la partie
+    size_t octets = 0; //octets des blocs alloués, estimés à partir de la capacité des conteneurs
+    size_t allocations = 0; //nombre de blocs alloués
+};
+
+//! \brief mémoire allouée dynamiquement par un objet, une entrée par partie
+struct MemoireUtilisee
+{
+    std::vector<MemoirePartie> parties;
+
+    size_t totalOctets() const;
+    size_t totalAllocations() const;
+};
+
+//surcoût, en octets, d'un noeud de std::map, std::multimap ou std::set (couleur et liens parent, gauche et droite)
+const size_t surcoutNoeudArbre = 4 * sizeof(void *);
+//surcoût d'un bloc de std::make_shared (pointeur de table virtuelle et deux compteurs de références)
+const size_t surcoutBlocPartage = sizeof(void *) + 2 * sizeof(int);
+
+//! \brief ajoute le bloc d'une chaîne, s'il y en a un (les chaînes courtes sont stockées dans l'objet lui-même)
+inline void ajouterMemoire(MemoirePartie &p_partie, const std::string &p_chaine)
+{
+    uintptr_t donnees = reinterpret_cast<uintptr_t>(p_chaine.data());
+    uintptr_t objet = reinterpret_cast<uintptr_t>(&p_chaine);
+    if (donnees >= objet && donnees < objet + sizeof(std::string)) return;
+    p_partie.octets += p_chaine.capacity() + 1;
+    ++p_partie.allocations;
+}
+
+//! \brief ajoute le bloc d'un vecteur (sans le contenu alloué par ses éléments)
+template<typename T>
+void ajouterMemoire(MemoirePartie &p_partie, const std::vector<T> &p_vecteur)
+{
+    if (p_vecteur.capacity() == 0) return;
+    p_partie.octets += p_vecteur.capacity() * sizeof(T);
+    ++p_partie.allocations;
+}
+
+//! \brief ajoute les noeuds d'un std::map, std::multimap ou std::set (sans le contenu alloué par ses éléments)
+template<typename Arbre>
+void ajouterMemoireArbre(MemoirePartie &p_partie, const Arbre &p_arbre)
+{
+    p_partie.octets += p_arbre.size() * (surcoutNoeudArbre + sizeof(typename Arbre::value_type));
+    p_partie.allocations += p_arbre.size();
+}
+
+//! \brief ajoute les noeuds et les alvéoles d'un std::unordered_map ou std::unordered_set
+//! (sans le contenu alloué par ses éléments); comme libstdc++, la valeur de hachage n'est conservée dans
+//! le noeud que pour les clés std::string
+template<typename Table>
+void ajouterMemoireTable(MemoirePartie &p_partie, const Table &p_table)
+{
+    const size_t hachage = std::is_same<typename Table::key_type, std::string>::value ? sizeof(size_t) : 0;
+    p_partie.octets += p_table.size() * (sizeof(void *) + sizeof(typename Table::value_type) + hachage);
+    p_partie.allocations += p_table.size();
+    if (p_table.bucket_count() > 1)
+    {
+        p_partie.octets += p_table.bucket_count() * sizeof(void *);
+        ++p_partie.allocations;
+    }
+}
+
+/*!
+ * \class Chronometre
+ * \brief Mesure le temps écoulé (et le nombre d'allocations, si elles sont suivies) depuis sa création.
+ */
+class Chronometre
+{
+public:
+    Chronometre();
+    double ecouleMs() const;
+    size_t allocations() const;
+
+private:
+    std::chrono::steady_clock::time_point m_debut;
+    size_t m_allocationsDebut;
+};
+
+bool allocationsSuivies();
+size_t compteurAllocations();
+size_t octetsAlloues();
+
+void ecrireChaineJSON(std::ostream &p_flux, const std::string &p_chaine);
+void ecrireJSON(std::ostream &p_flux, const MetriquesDonnees &p_metriques);
+void ecrireJSON(std::ostream &p_flux, const MetriquesReseau &p_metriques);
+void ecrireJSON(std::ostream &p_flux, const MemoireUtilisee &p_memoire);
+
+
+#endif //RTC_METRIQUES_H
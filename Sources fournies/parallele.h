@@ -0,0 +1,71 @@
+//
+// Outils pour répartir un traitement sur plusieurs fils d'exécution
+//
+
+#ifndef RTC_PARALLELE_H
+#define RTC_PARALLELE_H
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+//! \brief détermine le nombre de fils d'exécution à utiliser pour traiter p_n éléments
+//! \param[in] p_demande: le nombre de fils désiré (0 = nombre de coeurs de la machine)
+//! \param[in] p_n: le nombre d'éléments à traiter
+//! \return un nombre entre 1 et max(p_n, 1)
+inline unsigned int nbThreadsEffectifs(unsigned int p_demande, size_t p_n)
+{
+    unsigned int nb = p_demande;
+    if (nb == 0) nb = std::thread::hardware_concurrency();
+    if (nb == 0) nb = 1;
+    if (p_n < nb) nb = (unsigned int) std::max<size_t>(p_n, 1);
+    return nb;
+}
+
+//! \brief partitionne [0, p_n) en p_nbBlocs intervalles contigus et appelle p_fonction(bloc, debut, fin) sur chacun en parallèle
+//! \param[in] p_nbBlocs: le nombre de blocs (obtenu de nbThreadsEffectifs); le bloc b précède toujours le bloc b+1
+//! \post tous les blocs sont terminés au retour
+//! \post si un fil ne peut être lancé, les blocs restants sont exécutés par le fil appelant
+//! \throws la première exception levée par p_fonction, le cas échéant
+template<typename Fonction>
+void executerParBlocs(size_t p_n, unsigned int p_nbBlocs, Fonction p_fonction)
+{
+    if (p_nbBlocs <= 1)
+    {
+        p_fonction(0u, (size_t) 0, p_n);
+        return;
+    }
+    std::vector<std::exception_ptr> erreurs(p_nbBlocs);
+    auto executer = [&p_fonction, &erreurs, p_n, p_nbBlocs](unsigned int b)
+    {
+        try
+        {
+            p_fonction(b, p_n * b / p_nbBlocs, p_n * (b + 1) / p_nbBlocs);
+        }
+        catch (...)
+        {
+            erreurs[b] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> fils;
+    fils.reserve(p_nbBlocs);
+    unsigned int b = 0;
+    for (; b < p_nbBlocs; ++b)
+    {
+        try
+        {
+            fils.emplace_back(executer, b);
+        }
+        catch (...)
+        {
+            break; //les fils déjà lancés doivent être attendus: on termine le travail sans eux
+        }
+    }
+    for (; b < p_nbBlocs; ++b) executer(b);
+    for (auto &f : fils) f.join();
+    for (auto &e : erreurs)
+        if (e) std::rethrow_exception(e);
+}
+
+#endif //RTC_PARALLELE_H
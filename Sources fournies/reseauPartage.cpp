@@ -0,0 +1,140 @@
+//
+// Réseau GTFS partagé entre les requêtes et remplacé à chaud lors du rechargement du GTFS
+//
+
+#include "reseauPartage.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+//! \brief charge le GTFS de p_source et construit son réseau
+//! \throws logic_error si aucun service n'est offert à la date de p_source, ou si le chargement échoue
+VersionReseau::VersionReseau(const SourceGTFS &p_source)
+        : m_source(p_source), m_donnees(chargerDonnees(p_source)), m_reseau(m_donnees, p_source.options)
+{
+}
+
+//les mêmes étapes de chargement que main()
+DonneesGTFS VersionReseau::chargerDonnees(const SourceGTFS &p_source)
+{
+    DonneesGTFS donnees(p_source.date, p_source.debut, p_source.fin);
+    donnees.ajouterLignes(p_source.dossier + "/routes.txt");
+    donnees.ajouterStations(p_source.dossier + "/stops.txt");
+    donnees.ajouterServices(p_source.dossier + "/calendar_dates.txt");
+    if (donnees.getNbServices() == 0)
+        throw logic_error("VersionReseau: aucun service à cette date dans " + p_source.dossier);
+    donnees.ajouterVoyagesDeLaDate(p_source.dossier + "/trips.txt");
+    donnees.ajouterArretsDesVoyagesDeLaDate(p_source.dossier + "/stop_times.txt");
+    donnees.ajouterTransferts(p_source.dossier + "/transfers.txt");
+    return donnees;
+}
+
+const SourceGTFS &VersionReseau::getSource() const
+{
+    return m_source;
+}
+
+const DonneesGTFS &VersionReseau::getDonnees() const
+{
+    return m_donnees;
+}
+
+const ReseauGTFS &VersionReseau::getReseau() const
+{
+    return m_reseau;
+}
+
+//! \brief construit un détenteur sans version (getVersion() retourne nullptr jusqu'à la première publication)
+ReseauPartage::ReseauPartage() : m_rechargementEnCours(false), m_nbPublications(0)
+{
+}
+
+//! \brief attend la fin du rechargement en cours, le cas échéant
+ReseauPartage::~ReseauPartage()
+{
+    attendreRechargement();
+}
+
+//! \brief retourne la version courante (nullptr si aucune n'a été publiée)
+//! \brief La version retournée reste valide tant qu'elle est détenue, même si une autre est publiée entre-temps
+ReseauPartage::Version ReseauPartage::getVersion() const
+{
+    return atomic_load(&m_version);
+}
+
+//! \brief remplace la version courante; les requêtes en cours terminent sur l'ancienne version
+//! \throws logic_error si p_version est nullptr
+void ReseauPartage::publier(Version p_version)
+{
+    if (!p_version) throw logic_error("ReseauPartage::publier(): version nulle");
+    atomic_store(&m_version, std::move(p_version));
+    ++m_nbPublications;
+}
+
+//! \brief construit une version à partir de p_source, dans le fil appelant, puis la publie
+//! \throws logic_error si la construction échoue; la version courante est alors conservée
+void ReseauPartage::charger(const SourceGTFS &p_source)
+{
+    publier(make_shared<const VersionReseau>(p_source));
+}
+
+//! \brief construit une version à partir de p_source dans un fil d'arrière-plan, puis la publie
+//! \brief Si la construction échoue, la version courante est conservée et getDerniereErreur() en donne la raison
+//! \return false (sans rien faire) si un rechargement est déjà en cours
+//! \throws system_error si le fil ne peut être lancé; un rechargement ultérieur reste alors possible
+bool ReseauPartage::rechargerEnArrierePlan(const SourceGTFS &p_source)
+{
+    if (m_rechargementEnCours.exchange(true)) return false;
+    try
+    {
+        lock_guard<mutex> verrouFil(m_mutexFil);
+        if (m_filRechargement.joinable()) m_filRechargement.join();
+        m_filRechargement = thread([this, p_source]()
+        {
+            try
+            {
+                charger(p_source);
+                lock_guard<mutex> verrou(m_mutexErreur);
+                m_derniereErreur.clear();
+            }
+            catch (const exception &e)
+            {
+                lock_guard<mutex> verrou(m_mutexErreur);
+                m_derniereErreur = e.what();
+            }
+            m_rechargementEnCours = false;
+        });
+    }
+    catch (...)
+    {
+        //aucun fil n'a été lancé: sans cela, tout rechargement ultérieur serait refusé
+        m_rechargementEnCours = false;
+        throw;
+    }
+    return true;
+}
+
+//! \brief attend la fin du rechargement en arrière-plan en cours, le cas échéant
+void ReseauPartage::attendreRechargement()
+{
+    lock_guard<mutex> verrouFil(m_mutexFil);
+    if (m_filRechargement.joinable()) m_filRechargement.join();
+}
+
+bool ReseauPartage::rechargementEnCours() const
+{
+    return m_rechargementEnCours;
+}
+
+std::string ReseauPartage::getDerniereErreur() const
+{
+    lock_guard<mutex> verrou(m_mutexErreur);
+    return m_derniereErreur;
+}
+
+//! \brief retourne le nombre de versions publiées depuis la construction
+uint64_t ReseauPartage::getNbPublications() const
+{
+    return m_nbPublications;
+}
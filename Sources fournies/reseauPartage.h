@@ -0,0 +1,92 @@
+//
+// Réseau GTFS partagé entre les requêtes et remplacé à chaud lors du rechargement du GTFS
+//
+
+#ifndef RTC_RESEAUPARTAGE_H
+#define RTC_RESEAUPARTAGE_H
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+//! \brief ce qu'il faut pour charger un GTFS et construire son réseau (voir VersionReseau)
+struct SourceGTFS
+{
+    std::string dossier = "../RTC-1aout-30nov"; //le dossier des fichiers du GTFS
+    Date date; //la date des voyages retenus
+    Heure debut; //les arrêts retenus sont dans [debut, fin)
+    Heure fin;
+    OptionsReseau options; //les options de construction du réseau
+};
+
+/*!
+ * \class VersionReseau
+ * \brief Les données d'un GTFS et le réseau construit à partir d'elles, qui ne changent plus une fois construits.
+ * Les requêtes passent par ReseauGTFS::calculerItineraire(..., p_heureDepart, ...), qui ne modifie pas le réseau:
+ * plusieurs fils d'exécution peuvent donc interroger une même version simultanément.
+ */
+class VersionReseau
+{
+
+public:
+    explicit VersionReseau(const SourceGTFS &);
+
+    const SourceGTFS & getSource() const;
+    const DonneesGTFS & getDonnees() const;
+    const ReseauGTFS & getReseau() const;
+
+private:
+    SourceGTFS m_source;
+    DonneesGTFS m_donnees;
+    ReseauGTFS m_reseau;
+
+    static DonneesGTFS chargerDonnees(const SourceGTFS &);
+};
+
+/*!
+ * \class ReseauPartage
+ * \brief Détient la version courante du réseau et la remplace par une nouvelle sans interrompre les requêtes.
+ * Une requête obtient la version courante par getVersion() et la conserve jusqu'à sa fin, même si une autre version est
+ * publiée entre-temps. La publication remplace le pointeur partagé de façon atomique (std::atomic_store): les requêtes
+ * suivantes voient la nouvelle version, sans jamais attendre sa construction. Une version est détruite lorsque la
+ * dernière requête qui la détient se termine.
+ * \note Le rechargement en arrière-plan garde deux versions en mémoire le temps de construire la nouvelle.
+ */
+class ReseauPartage
+{
+
+public:
+    typedef std::shared_ptr<const VersionReseau> Version;
+
+    ReseauPartage();
+    ~ReseauPartage();
+    ReseauPartage(const ReseauPartage &) = delete;
+    ReseauPartage &operator=(const ReseauPartage &) = delete;
+
+    Version getVersion() const;
+    void publier(Version);
+    void charger(const SourceGTFS &);
+    bool rechargerEnArrierePlan(const SourceGTFS &);
+    void attendreRechargement();
+    bool rechargementEnCours() const;
+    std::string getDerniereErreur() const;
+    uint64_t getNbPublications() const;
+
+private:
+    Version m_version; //la version courante; lue et remplacée seulement par std::atomic_load et std::atomic_store
+    std::thread m_filRechargement;
+    std::mutex m_mutexFil; //protège m_filRechargement, que plusieurs fils peuvent lancer ou attendre
+    std::atomic<bool> m_rechargementEnCours;
+    std::atomic<uint64_t> m_nbPublications;
+    mutable std::mutex m_mutexErreur; //protège m_derniereErreur
+    std::string m_derniereErreur; //le message du dernier rechargement en arrière-plan qui a échoué (vide si aucun)
+};
+
+
+#endif //RTC_RESEAUPARTAGE_H
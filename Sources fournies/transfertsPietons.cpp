@@ -0,0 +1,184 @@
+//
+// Prétraitement du réseau piétonnier (transferts à pieds entre stations)
+//
+
+#include "transfertsPietons.h"
+#include "parallele.h"
+
+#include <map>
+#include <numeric>
+
+using namespace std;
+
+TransfertsPietons::TransfertsPietons() : m_nbRaccourcis(0)
+{
+}
+
+uint64_t TransfertsPietons::cle(unsigned int p_de, unsigned int p_vers)
+{
+    return ((uint64_t) p_de << 32) | p_vers;
+}
+
+//! \brief contracte le réseau piétonnier décrit par des transferts entre stations
+//! \param[in] p_transferts: les transferts directs <from_station_id, to_station_id, temps>
+//! \param[in] p_tempsMax: aucun raccourci d'un temps supérieur à p_tempsMax n'est créé (les transferts directs sont conservés)
+//! \param[in] p_nbThreads: le nombre de fils d'exécution à utiliser (0 = nombre de coeurs)
+//! \param[in] p_contracter: si faux, aucun raccourci n'est calculé et seuls les transferts directs sont indexés
+//! \post les composantes (faiblement) connexes du réseau sont contractées indépendamment, en parallèle
+//! \post getTransferts() contient, pour chaque paire reliée, le plus petit temps de marche n'excédant pas p_tempsMax
+TransfertsPietons::TransfertsPietons(const vector<Transfert> &p_transferts, unsigned int p_tempsMax,
+                                     unsigned int p_nbThreads, bool p_contracter)
+        : m_nbRaccourcis(0)
+{
+    map<uint64_t, unsigned int> directs;
+    for (const auto &t : p_transferts)
+    {
+        auto res = directs.emplace(cle(get<0>(t), get<1>(t)), get<2>(t));
+        if (!res.second && get<2>(t) < res.first->second) res.first->second = get<2>(t);
+    }
+    if (!p_contracter)
+    {
+        m_transferts.reserve(directs.size());
+        m_temps.reserve(directs.size());
+        for (const auto &d : directs)
+        {
+            m_transferts.emplace_back(d.first >> 32, d.first & 0xFFFFFFFFu, d.second);
+            m_temps.insert(d);
+        }
+        return;
+    }
+
+    //numérotation des stations et regroupement en composantes (union-find)
+    map<unsigned int, size_t> indiceDeStation;
+    for (const auto &t : p_transferts)
+    {
+        indiceDeStation.emplace(get<0>(t), 0);
+        indiceDeStation.emplace(get<1>(t), 0);
+    }
+    vector<unsigned int> stationDeIndice;
+    for (auto &s : indiceDeStation)
+    {
+        s.second = stationDeIndice.size();
+        stationDeIndice.push_back(s.first);
+    }
+    size_t n = stationDeIndice.size();
+    vector<size_t> parent(n);
+    iota(parent.begin(), parent.end(), 0);
+    auto racine = [&parent](size_t i)
+    {
+        while (parent[i] != i) i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    for (const auto &t : p_transferts)
+    {
+        parent[racine(indiceDeStation[get<0>(t)])] = racine(indiceDeStation[get<1>(t)]);
+    }
+
+    map<size_t, vector<size_t> > composantesParRacine;
+    for (size_t i = 0; i < n; ++i)
+    {
+        composantesParRacine[racine(i)].push_back(i);
+    }
+    vector<vector<size_t> > composantes;
+    for (auto &c : composantesParRacine) composantes.push_back(move(c.second));
+
+    //listes d'adjacence (sortantes et entrantes), indexées par station
+    vector<unordered_map<size_t, unsigned int> > sortants(n), entrants(n);
+    for (const auto &d : directs)
+    {
+        size_t u = indiceDeStation[d.first >> 32];
+        size_t w = indiceDeStation[d.first & 0xFFFFFFFFu];
+        sortants[u][w] = d.second;
+        entrants[w][u] = d.second;
+    }
+
+    //contraction: les composantes ne partagent aucune station, elles peuvent donc être traitées en parallèle
+    unsigned int nbBlocs = nbThreadsEffectifs(p_nbThreads, composantes.size());
+    vector<vector<Transfert> > resultatsParBloc(nbBlocs);
+    executerParBlocs(composantes.size(), nbBlocs, [&](unsigned int p_bloc, size_t p_debut, size_t p_fin)
+    {
+        for (size_t c = p_debut; c < p_fin; ++c)
+        {
+            vector<size_t> ordre = composantes[c];
+            stable_sort(ordre.begin(), ordre.end(), [&](size_t a, size_t b)
+            {
+                return sortants[a].size() + entrants[a].size() < sortants[b].size() + entrants[b].size();
+            });
+            for (size_t v : ordre)
+            {
+                for (const auto &arcEntrant : entrants[v])
+                {
+                    size_t u = arcEntrant.first;
+                    if (u == v) continue;
+                    for (const auto &arcSortant : sortants[v])
+                    {
+                        size_t w = arcSortant.first;
+                        if (w == v || w == u) continue;
+                        uint64_t temps = (uint64_t) arcEntrant.second + arcSortant.second;
+                        if (temps > p_tempsMax) continue;
+                        auto itr = sortants[u].find(w);
+                        if (itr == sortants[u].end() || temps < itr->second)
+                        {
+                            sortants[u][w] = (unsigned int) temps;
+                            entrants[w][u] = (unsigned int) temps;
+                        }
+                    }
+                }
+            }
+            for (size_t u : composantes[c])
+            {
+                for (const auto &arc : sortants[u])
+                {
+                    resultatsParBloc[p_bloc].emplace_back(stationDeIndice[u], stationDeIndice[arc.first], arc.second);
+                }
+            }
+        }
+    });
+
+    for (auto &resultats : resultatsParBloc)
+    {
+        m_transferts.insert(m_transferts.end(), resultats.begin(), resultats.end());
+    }
+    sort(m_transferts.begin(), m_transferts.end());
+    m_temps.reserve(m_transferts.size());
+    for (const auto &t : m_transferts)
+    {
+        m_temps.emplace(cle(get<0>(t), get<1>(t)), get<2>(t));
+        if (directs.find(cle(get<0>(t), get<1>(t))) == directs.end()) ++m_nbRaccourcis;
+    }
+}
+
+//! \brief donne le temps de marche minimal entre deux stations, en O(1)
+//! \param[in] p_de: la station de départ
+//! \param[in] p_vers: la station d'arrivée
+//! \param[out] p_temps: le temps de marche, en secondes, si les stations sont reliées
+//! \return true ssi les stations sont reliées par le réseau piétonnier
+bool TransfertsPietons::tempsDeMarche(unsigned int p_de, unsigned int p_vers, unsigned int &p_temps) const
+{
+    auto itr = m_temps.find(cle(p_de, p_vers));
+    if (itr == m_temps.end()) return false;
+    p_temps = itr->second;
+    return true;
+}
+
+//! \brief retourne les transferts directs et les raccourcis, triés par station de départ puis d'arrivée
+const vector<TransfertsPietons::Transfert> &TransfertsPietons::getTransferts() const
+{
+    return m_transferts;
+}
+
+size_t TransfertsPietons::getNbRaccourcis() const
+{
+    return m_nbRaccourcis;
+}
+
+//! \brief retourne la mémoire allouée par la table des temps de marche et la liste des transferts
+MemoirePartie TransfertsPietons::memoireUtilisee() const
+{
+    MemoirePartie memoire;
+    memoire.partie = "transfertsPietons";
+    ajouterMemoireTable(memoire, m_temps);
+    ajouterMemoire(memoire, m_transferts);
+    return memoire;
+}
@@ -0,0 +1,51 @@
+//
+// Prétraitement du réseau piétonnier (transferts à pieds entre stations)
+//
+
+#ifndef RTC_TRANSFERTSPIETONS_H
+#define RTC_TRANSFERTSPIETONS_H
+
+#include <vector>
+#include <tuple>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+#include "metriques.h"
+
+/*!
+ * \class TransfertsPietons
+ * \brief Fermeture du réseau piétonnier formé par les transferts entre stations.
+ * Chaque station est contractée à tour de rôle (par degré croissant): pour tout transfert (u, v) et (v, w),
+ * un raccourci (u, w) de temps t(u, v) + t(v, w) est ajouté s'il améliore le temps connu.
+ * Une fois toutes les stations contractées, chaque paire reliée par une chaîne de transferts l'est directement;
+ * le temps de marche entre deux stations s'obtient alors par une seule recherche dans une table de hachage.
+ * Sans contraction, seuls les transferts directs sont indexés.
+ */
+class TransfertsPietons
+{
+
+public:
+    typedef std::tuple<unsigned int, unsigned int, unsigned int> Transfert; // <from_station_id, to_station_id, temps>
+
+    TransfertsPietons();
+    explicit TransfertsPietons(const std::vector<Transfert> &p_transferts,
+                               unsigned int p_tempsMax = std::numeric_limits<unsigned int>::max(),
+                               unsigned int p_nbThreads = 0, bool p_contracter = true);
+
+    bool tempsDeMarche(unsigned int p_de, unsigned int p_vers, unsigned int &p_temps) const;
+    const std::vector<Transfert> &getTransferts() const;
+    size_t getNbRaccourcis() const;
+    MemoirePartie memoireUtilisee() const;
+
+private:
+    std::unordered_map<uint64_t, unsigned int> m_temps; //m_temps[(de << 32) | vers] est le temps de marche de de vers vers
+    std::vector<Transfert> m_transferts; //les transferts directs et les raccourcis, triés par (de, vers)
+    size_t m_nbRaccourcis; //le nombre de paires absentes des transferts directs
+
+    static uint64_t cle(unsigned int p_de, unsigned int p_vers);
+};
+
+
+#endif //RTC_TRANSFERTSPIETONS_H
@@ -0,0 +1,123 @@
+//
+// Comparaison des lecteurs d'heures et de dates GTFS:
+// l'ancienne méthode (string_to_vector + strtoul, substr + stoul) et Heure::depuisGTFS / Date::depuisGTFS
+//
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "auxiliaires.h"
+
+using namespace std;
+
+//ancienne lecture d'une heure, telle que faite par DonneesGTFS::stringToHeure avant Heure::depuisGTFS
+static vector<string> ancien_string_to_vector(const string &s, char delim)
+{
+    stringstream ss(s);
+    string item;
+    vector<string> elems;
+    while (getline(ss, item, delim))
+    {
+        elems.push_back(item);
+    }
+    return elems;
+}
+
+static Heure ancienneLectureHeure(const string &p_heureEnString)
+{
+    vector<string> stringHeureVector = ancien_string_to_vector(p_heureEnString, ':');
+    unsigned int heure = strtoul(stringHeureVector[0].c_str(), nullptr, 10);
+    unsigned int minute = strtoul(stringHeureVector[1].c_str(), nullptr, 10);
+    unsigned int seconde = strtoul(stringHeureVector[2].c_str(), nullptr, 10);
+    return Heure(heure, minute, seconde);
+}
+
+//ancienne lecture d'une date, telle que faite par DonneesGTFS::traitementService avant Date::depuisGTFS
+static Date ancienneLectureDate(const string &dateLigneStr)
+{
+    unsigned int an = stoul(dateLigneStr.substr(0, 4), nullptr, 10);
+    unsigned int mois = stoul(dateLigneStr.substr(4, 2), nullptr, 10);
+    unsigned int jour = stoul(dateLigneStr.substr(6, 2), nullptr, 10);
+    return Date(an, mois, jour);
+}
+
+//! \brief mesure le temps moyen, en nanosecondes, d'un appel de p_lire sur chaque élément de p_entrees
+template<typename T, typename Lecteur>
+static double mesurer(const vector<string> &p_entrees, unsigned int p_repetitions, Lecteur p_lire,
+                      vector<T> &p_resultats)
+{
+    p_resultats.clear();
+    p_resultats.reserve(p_entrees.size());
+    for (const auto &e : p_entrees) p_resultats.push_back(p_lire(e)); //réchauffement
+    auto debut = chrono::steady_clock::now();
+    for (unsigned int r = 0; r < p_repetitions; ++r)
+    {
+        for (size_t i = 0; i < p_entrees.size(); ++i) p_resultats[i] = p_lire(p_entrees[i]);
+    }
+    auto fin = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(fin - debut).count() / (double(p_entrees.size()) * p_repetitions);
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t nbEntrees = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const unsigned int repetitions = argc > 2 ? (unsigned int) strtoul(argv[2], nullptr, 10) : 5;
+
+    //heures d'une journée de service (jusqu'à 27h) et dates d'un horaire de quatre mois, comme dans le RTC
+    mt19937 generateur(2018);
+    uniform_int_distribution<unsigned int> secondes(4 * 3600, 27 * 3600);
+    uniform_int_distribution<unsigned int> jours(0, 121);
+    vector<string> heures;
+    vector<string> dates;
+    heures.reserve(nbEntrees);
+    dates.reserve(nbEntrees);
+    for (size_t i = 0; i < nbEntrees; ++i)
+    {
+        unsigned int code = secondes(generateur);
+        ostringstream h;
+        h << setfill('0') << setw(2) << code / 3600 << ":" << setw(2) << code % 3600 / 60 << ":" << setw(2) << code % 60;
+        heures.push_back(h.str());
+        unsigned int jour = jours(generateur);
+        unsigned int mois = 8 + jour / 31;
+        ostringstream d;
+        d << "2018" << setfill('0') << setw(2) << mois << setw(2) << jour % 31 + 1;
+        dates.push_back(d.str());
+    }
+
+    vector<Heure> anciennesHeures;
+    vector<Heure> nouvellesHeures;
+    vector<Date> anciennesDates;
+    vector<Date> nouvellesDates;
+    double tAncienneHeure = mesurer(heures, repetitions, ancienneLectureHeure, anciennesHeures);
+    double tNouvelleHeure = mesurer(heures, repetitions, [](const string &s)
+    {
+        return Heure::depuisGTFS(s.data(), s.data() + s.size());
+    }, nouvellesHeures);
+    double tAncienneDate = mesurer(dates, repetitions, ancienneLectureDate, anciennesDates);
+    double tNouvelleDate = mesurer(dates, repetitions, [](const string &s)
+    {
+        return Date::depuisGTFS(s.data(), s.data() + s.size());
+    }, nouvellesDates);
+
+    for (size_t i = 0; i < nbEntrees; ++i)
+    {
+        if (!(anciennesHeures[i] == nouvellesHeures[i]) || !(anciennesDates[i] == nouvellesDates[i]))
+        {
+            cerr << "Résultats différents pour " << heures[i] << " ou " << dates[i] << endl;
+            return 1;
+        }
+    }
+
+    cout << nbEntrees << " entrées, " << repetitions << " répétitions" << endl;
+    cout << fixed << setprecision(1);
+    cout << "heure  ancienne: " << setw(8) << tAncienneHeure << " ns   Heure::depuisGTFS: " << setw(6) << tNouvelleHeure
+         << " ns   (x" << tAncienneHeure / tNouvelleHeure << ")" << endl;
+    cout << "date   ancienne: " << setw(8) << tAncienneDate << " ns   Date::depuisGTFS:  " << setw(6) << tNouvelleDate
+         << " ns   (x" << tAncienneDate / tNouvelleDate << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,243 @@
+//
+// Micro-bancs d'essai (Google Benchmark) des primitives les plus sollicitées lors du chargement et des requêtes:
+// découpage d'une ligne (string_to_vector), lecture d'une heure (stringToHeure), distance entre deux coordonnées,
+// ajout/retrait d'arcs dans le graphe et insertion des arrêts dans une station ou un voyage.
+// Les entrées proviennent du GTFS du RTC (dossier passé en argument, ../RTC-1aout-30nov par défaut).
+//
+// Usage: BenchPrimitives [options de Google Benchmark] [dossier GTFS]
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arret.h"
+#include "auxiliaires.h"
+#include "coordonnees.h"
+#include "DonneesGTFS.h"
+#include "graphe.h"
+#include "station.h"
+#include "voyage.h"
+
+using namespace std;
+
+namespace
+{
+
+const size_t nbLignesMax = 200000; //lignes de stop_times.txt conservées comme entrées
+
+/*!
+ * \brief Entrées réelles tirées du GTFS, chargées une seule fois pour tous les bancs d'essai
+ */
+struct EntreesRTC
+{
+    string erreur; //non vide si le GTFS n'a pu être lu
+    vector<string> lignesStopTimes; //lignes brutes de stop_times.txt (sans l'en-tête)
+    vector<string> heures; //champs arrival_time et departure_time de ces lignes
+    vector<Coordonnees> coordonnees; //positions des stations de stops.txt
+    vector<Arret::Ptr> arretsStation; //arrêts de la station la plus desservie parmi les lignes lues
+    vector<Arret::Ptr> arretsVoyage; //arrêts du voyage le plus long parmi les lignes lues, dans l'ordre du fichier
+};
+
+string dossierGTFS = "../RTC-1aout-30nov";
+
+void lireStopTimes(EntreesRTC &p_entrees)
+{
+    ifstream fichier(dossierGTFS + "/stop_times.txt");
+    if (!fichier)
+    {
+        p_entrees.erreur = "impossible d'ouvrir " + dossierGTFS + "/stop_times.txt";
+        return;
+    }
+    string ligne;
+    getline(fichier, ligne); //en-tête
+    map<unsigned int, vector<Arret::Ptr>> parStation;
+    map<string, vector<Arret::Ptr>> parVoyage;
+    while (p_entrees.lignesStopTimes.size() < nbLignesMax && getline(fichier, ligne))
+    {
+        if (!ligne.empty() && ligne.back() == '\r') ligne.pop_back();
+        vector<string> champs = DonneesGTFS::string_to_vector(ligne, ',');
+        if (champs.size() < 5) continue;
+        p_entrees.lignesStopTimes.push_back(ligne);
+        p_entrees.heures.push_back(champs[1]);
+        p_entrees.heures.push_back(champs[2]);
+        auto arret = make_shared<Arret>(stoul(champs[3]), DonneesGTFS::stringToHeure(champs[1]),
+                                        DonneesGTFS::stringToHeure(champs[2]), stoul(champs[4]), champs[0]);
+        parStation[arret->getStationId()].push_back(arret);
+        parVoyage[champs[0]].push_back(arret);
+    }
+    auto plusLong = [](const pair<const unsigned int, vector<Arret::Ptr>> &a,
+                       const pair<const unsigned int, vector<Arret::Ptr>> &b)
+    { return a.second.size() < b.second.size(); };
+    if (!parStation.empty())
+        p_entrees.arretsStation = max_element(parStation.begin(), parStation.end(), plusLong)->second;
+    for (auto &v : parVoyage)
+        if (v.second.size() > p_entrees.arretsVoyage.size()) p_entrees.arretsVoyage = v.second;
+}
+
+void lireStops(EntreesRTC &p_entrees)
+{
+    ifstream fichier(dossierGTFS + "/stops.txt");
+    if (!fichier)
+    {
+        p_entrees.erreur = "impossible d'ouvrir " + dossierGTFS + "/stops.txt";
+        return;
+    }
+    string ligne;
+    getline(fichier, ligne); //en-tête
+    while (getline(fichier, ligne))
+    {
+        vector<string> champs = DonneesGTFS::string_to_vector(ligne, ',');
+        if (champs.size() < 5) continue;
+        p_entrees.coordonnees.emplace_back(stod(champs[3]), stod(champs[4]));
+    }
+}
+
+const EntreesRTC &entrees()
+{
+    static const EntreesRTC e = []
+    {
+        EntreesRTC r;
+        lireStops(r);
+        if (r.erreur.empty()) lireStopTimes(r);
+        if (r.erreur.empty() && (r.lignesStopTimes.empty() || r.coordonnees.size() < 2))
+            r.erreur = "GTFS vide dans " + dossierGTFS;
+        return r;
+    }();
+    return e;
+}
+
+//! \brief retourne vrai (après avoir signalé l'erreur) si les entrées sont inutilisables
+bool entreesInvalides(benchmark::State &p_state)
+{
+    if (entrees().erreur.empty()) return false;
+    p_state.SkipWithError(entrees().erreur.c_str());
+    return true;
+}
+
+void BM_StringToVector(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const auto &lignes = entrees().lignesStopTimes;
+    size_t i = 0;
+    int64_t octets = 0;
+    for (auto _ : state)
+    {
+        const string &ligne = lignes[i];
+        benchmark::DoNotOptimize(DonneesGTFS::string_to_vector(ligne, ','));
+        octets += ligne.size();
+        if (++i == lignes.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(octets);
+}
+BENCHMARK(BM_StringToVector);
+
+void BM_StringToHeure(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const auto &heures = entrees().heures;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(DonneesGTFS::stringToHeure(heures[i]));
+        if (++i == heures.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringToHeure);
+
+//paires de stations tirées au hasard, comme les couples origine/station d'une requête
+void BM_CoordonneesDistance(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const auto &coords = entrees().coordonnees;
+    mt19937 generateur(2018);
+    uniform_int_distribution<size_t> station(0, coords.size() - 1);
+    vector<pair<size_t, size_t>> paires(4096);
+    for (auto &p : paires) p = {station(generateur), station(generateur)};
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(coords[paires[i].first] - coords[paires[i].second]);
+        i = (i + 1) & (paires.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoordonneesDistance);
+
+//motif de ReseauGTFS::ajouterArcsOrigineDestination / enleverArcsOrigineDestination:
+//range(0) arcs partant du sommet origine puis range(0) arcs menant au sommet destination, enlevés ensuite
+void BM_GrapheAjouterEnleverArc(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const size_t nbArcs = static_cast<size_t>(state.range(0));
+    const size_t nbSommets = entrees().lignesStopTimes.size() + 2;
+    const size_t origine = nbSommets - 2;
+    const size_t destination = nbSommets - 1;
+    Graphe graphe(nbSommets);
+    mt19937 generateur(2018);
+    uniform_int_distribution<size_t> sommet(0, origine - 1);
+    vector<size_t> voisins(nbArcs);
+    for (auto &v : voisins) v = sommet(generateur);
+    for (auto _ : state)
+    {
+        for (size_t v : voisins) graphe.ajouterArc(origine, v, 300);
+        for (size_t v : voisins) graphe.ajouterArc(v, destination, 300);
+        for (size_t v : voisins) graphe.enleverArc(origine, v);
+        for (size_t v : voisins) graphe.enleverArc(v, destination);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(4 * nbArcs));
+}
+BENCHMARK(BM_GrapheAjouterEnleverArc)->Arg(16)->Arg(128)->Arg(1024);
+
+void BM_StationAddArret(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const auto &arrets = entrees().arretsStation;
+    for (auto _ : state)
+    {
+        Station station(arrets.front()->getStationId(), "station", "banc d'essai", entrees().coordonnees.front());
+        for (const auto &a : arrets) station.addArret(a);
+        benchmark::DoNotOptimize(station.getNbArrets());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(arrets.size()));
+    state.SetLabel(to_string(arrets.size()) + " arrets");
+}
+BENCHMARK(BM_StationAddArret);
+
+void BM_VoyageAjouterArret(benchmark::State &state)
+{
+    if (entreesInvalides(state)) return;
+    const auto &arrets = entrees().arretsVoyage;
+    for (auto _ : state)
+    {
+        Voyage voyage(arrets.front()->getVoyageId(), 0, "service", "banc d'essai");
+        for (const auto &a : arrets) voyage.ajouterArret(a);
+        benchmark::DoNotOptimize(voyage.getArrets().size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(arrets.size()));
+    state.SetLabel(to_string(arrets.size()) + " arrets");
+}
+BENCHMARK(BM_VoyageAjouterArret);
+
+}
+
+int main(int argc, char *argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    if (argc > 2)
+    {
+        benchmark::ReportUnrecognizedArguments(argc, argv);
+        return 1;
+    }
+    if (argc == 2) dossierGTFS = argv[1];
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,332 @@
+//
+// Banc d'essai reproductible du calcul d'itinéraires
+//
+// usage: BenchReseau [--gtfs dossier] [--date AAAAMMJJ] [--requetes N] [--repetitions R] [--echauffement W]
+//                    [--graine S] [--nbThreads T] [--moteurs m1,m2,...] [--etiquette texte] [--json fichier]
+//
+// Les données sont chargées une fois; des charges de requêtes (paires origine/destination et heure de départ) sont
+// générées à partir de la graine, puis chaque moteur (modèle de transferts, recherche guidée ou non) est construit et
+// exécute toutes les charges: W requêtes de réchauffement, puis R passes sur les N requêtes de chaque charge.
+// Pour une même graine, les requêtes sont identiques d'un moteur et d'une version du code à l'autre; le nombre de
+// destinations atteintes et la somme des temps de trajet permettent de vérifier que les résultats n'ont pas changé.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+using namespace std;
+
+//une requête: trajet entre deux stations, à partir d'une heure de départ
+struct Requete
+{
+    unsigned int origine;
+    unsigned int destination;
+    Heure depart;
+};
+
+//une charge: un ensemble de requêtes de même nature
+struct Charge
+{
+    string nom;
+    vector<Requete> requetes;
+};
+
+//un moteur: une façon de construire le réseau et d'y chercher les itinéraires
+struct Moteur
+{
+    string nom;
+    OptionsReseau options;
+};
+
+//résultats d'un moteur sur une charge
+struct ResultatCharge
+{
+    string charge;
+    double p50Us, p95Us, p99Us, moyenneUs; //latence d'une requête complète (ajout des arcs, recherche, retrait)
+    double rechercheP50Us, rechercheP99Us; //temps de la recherche seule (ReseauGTFS::itineraire())
+    double requetesParSeconde;
+    size_t atteintes; //destinations atteintes (première passe)
+    unsigned long long sommeTemps; //somme des temps de trajet des destinations atteintes (première passe)
+};
+
+struct ResultatMoteur
+{
+    string moteur;
+    double constructionMs;
+    size_t rssKo;
+    size_t nbSommets;
+    size_t nbArcs;
+    vector<ResultatCharge> charges;
+};
+
+//lit un champ (en ko) de /proc/self/status, 0 si indisponible
+static size_t lireMemoireKo(const string &p_champ)
+{
+    ifstream status("/proc/self/status");
+    string ligne;
+    while (getline(status, ligne))
+    {
+        if (ligne.compare(0, p_champ.size() + 1, p_champ + ":") == 0)
+            return strtoul(ligne.c_str() + p_champ.size() + 1, nullptr, 10);
+    }
+    return 0;
+}
+
+//centile p_p (entre 0 et 1), par la méthode du rang le plus proche
+static double centile(vector<double> p_valeurs, double p_p)
+{
+    if (p_valeurs.empty()) return 0;
+    size_t rang = (size_t) ceil(p_p * p_valeurs.size());
+    if (rang > 0) --rang;
+    nth_element(p_valeurs.begin(), p_valeurs.begin() + rang, p_valeurs.end());
+    return p_valeurs[rang];
+}
+
+//génère p_n requêtes dont la distance à vol d'oiseau est dans [p_distMin, p_distMax] et le départ dans [p_debut, p_fin)
+static Charge genererCharge(const string &p_nom, const DonneesGTFS &p_gtfs, const vector<unsigned int> &p_ids,
+                            mt19937 &p_generateur, size_t p_n, double p_distMin, double p_distMax,
+                            const Heure &p_debut, const Heure &p_fin)
+{
+    Charge charge;
+    charge.nom = p_nom;
+    uniform_int_distribution<size_t> station(0, p_ids.size() - 1);
+    uniform_int_distribution<int> seconde(0, p_fin - p_debut - 1);
+    const size_t essaisMax = 1000 * p_n + 1000;
+    for (size_t essai = 0; charge.requetes.size() < p_n; ++essai)
+    {
+        if (essai == essaisMax)
+            throw logic_error("genererCharge(): trop peu de paires de stations pour la charge " + p_nom);
+        unsigned int o = p_ids[station(p_generateur)];
+        unsigned int d = p_ids[station(p_generateur)];
+        Heure depart = p_debut.add_secondes((unsigned int) seconde(p_generateur));
+        double distance = p_gtfs.getStations().at(o).getCoords() - p_gtfs.getStations().at(d).getCoords();
+        if (o == d || distance < p_distMin || distance > p_distMax) continue;
+        charge.requetes.push_back({o, d, depart});
+    }
+    return charge;
+}
+
+//exécute une charge avec p_parametres: p_echauffement requêtes non mesurées, puis p_repetitions passes mesurées
+static ResultatCharge executerCharge(ReseauGTFS &p_reseau, const DonneesGTFS &p_gtfs, const Charge &p_charge,
+                                     const ParametresRecherche &p_parametres, unsigned int p_echauffement,
+                                     unsigned int p_repetitions)
+{
+    const auto &stations = p_gtfs.getStations();
+    auto executer = [&](const Requete &p_requete, long &p_tempsRecherche)
+    {
+        p_reseau.ajouterArcsOrigineDestination(p_gtfs, stations.at(p_requete.origine).getCoords(),
+                                               stations.at(p_requete.destination).getCoords(), p_requete.depart,
+                                               p_parametres);
+        unsigned int temps = p_reseau.itineraire(p_gtfs, false, p_tempsRecherche);
+        p_reseau.enleverArcsOrigineDestination();
+        return temps;
+    };
+
+    long tempsRecherche;
+    for (unsigned int w = 0; w < p_echauffement && !p_charge.requetes.empty(); ++w)
+    {
+        executer(p_charge.requetes[w % p_charge.requetes.size()], tempsRecherche);
+    }
+
+    ResultatCharge resultat = ResultatCharge();
+    resultat.charge = p_charge.nom;
+    vector<double> latences;
+    vector<double> recherches;
+    latences.reserve(p_charge.requetes.size() * p_repetitions);
+    recherches.reserve(p_charge.requetes.size() * p_repetitions);
+    auto debutTotal = chrono::steady_clock::now();
+    for (unsigned int r = 0; r < p_repetitions; ++r)
+    {
+        for (const Requete &requete : p_charge.requetes)
+        {
+            auto debut = chrono::steady_clock::now();
+            unsigned int temps = executer(requete, tempsRecherche);
+            latences.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - debut).count());
+            recherches.push_back((double) tempsRecherche);
+            if (r == 0 && temps != numeric_limits<unsigned int>::max())
+            {
+                ++resultat.atteintes;
+                resultat.sommeTemps += temps;
+            }
+        }
+    }
+    double totalSecondes = chrono::duration<double>(chrono::steady_clock::now() - debutTotal).count();
+
+    resultat.p50Us = centile(latences, 0.50);
+    resultat.p95Us = centile(latences, 0.95);
+    resultat.p99Us = centile(latences, 0.99);
+    double somme = 0;
+    for (double l : latences) somme += l;
+    resultat.moyenneUs = latences.empty() ? 0 : somme / latences.size();
+    resultat.rechercheP50Us = centile(recherches, 0.50);
+    resultat.rechercheP99Us = centile(recherches, 0.99);
+    resultat.requetesParSeconde = totalSecondes > 0 ? latences.size() / totalSecondes : 0;
+    return resultat;
+}
+
+//écrit les paramètres et les résultats du banc d'essai en JSON (un objet)
+static void ecrireResultatsJSON(ostream &p_flux, const string &p_etiquette, const string &p_gtfs, const string &p_date,
+                                unsigned int p_graine, size_t p_requetes, unsigned int p_repetitions,
+                                double p_chargementMs, size_t p_rssChargementKo, const vector<ResultatMoteur> &p_moteurs)
+{
+    p_flux << fixed << setprecision(1);
+    p_flux << "{\"etiquette\": ";
+    ecrireChaineJSON(p_flux, p_etiquette);
+    p_flux << ", \"gtfs\": ";
+    ecrireChaineJSON(p_flux, p_gtfs);
+    p_flux << ", \"date\": \"" << p_date << "\", \"graine\": " << p_graine << ", \"requetes\": " << p_requetes
+           << ", \"repetitions\": " << p_repetitions << ", \"chargementMs\": " << p_chargementMs
+           << ", \"rssChargementKo\": " << p_rssChargementKo
+           << ", \"rssMaxKo\": " << lireMemoireKo("VmHWM") << ", \"moteurs\": [";
+    for (size_t m = 0; m < p_moteurs.size(); ++m)
+    {
+        const ResultatMoteur &moteur = p_moteurs[m];
+        p_flux << (m ? ", " : "") << "{\"moteur\": \"" << moteur.moteur << "\", \"constructionMs\": "
+               << moteur.constructionMs << ", \"rssKo\": " << moteur.rssKo << ", \"nbSommets\": " << moteur.nbSommets
+               << ", \"nbArcs\": " << moteur.nbArcs << ", \"charges\": [";
+        for (size_t c = 0; c < moteur.charges.size(); ++c)
+        {
+            const ResultatCharge &r = moteur.charges[c];
+            p_flux << (c ? ", " : "") << "{\"charge\": \"" << r.charge << "\", \"p50Us\": " << r.p50Us
+                   << ", \"p95Us\": " << r.p95Us << ", \"p99Us\": " << r.p99Us << ", \"moyenneUs\": " << r.moyenneUs
+                   << ", \"rechercheP50Us\": " << r.rechercheP50Us << ", \"rechercheP99Us\": " << r.rechercheP99Us
+                   << ", \"requetesParSeconde\": " << r.requetesParSeconde << ", \"atteintes\": " << r.atteintes
+                   << ", \"sommeTemps\": " << r.sommeTemps << "}";
+        }
+        p_flux << "]}";
+    }
+    p_flux << "]}" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    string dossier = "../RTC-1aout-30nov";
+    string dateTexte = "20180921";
+    size_t nbRequetes = 100;
+    unsigned int repetitions = 3;
+    unsigned int echauffement = 10;
+    unsigned int graine = 2018;
+    unsigned int nbThreads = 0;
+    string listeMoteurs = "toutesLignes,chainesAttente,toutesLignesDijkstra,chainesAttenteDijkstra";
+    string etiquette;
+    string fichierJSON;
+    for (int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (i + 1 >= argc) throw logic_error("BenchReseau: valeur manquante pour " + option);
+        string valeur = argv[++i];
+        if (option == "--gtfs") dossier = valeur;
+        else if (option == "--date") dateTexte = valeur;
+        else if (option == "--requetes") nbRequetes = strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--repetitions") repetitions = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--echauffement") echauffement = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--graine") graine = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--nbThreads") nbThreads = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--moteurs") listeMoteurs = valeur;
+        else if (option == "--etiquette") etiquette = valeur;
+        else if (option == "--json") fichierJSON = valeur;
+        else throw logic_error("BenchReseau: option inconnue " + option);
+    }
+
+    //chargement des données: toute la journée de service, à partir de 5h
+    Date date = Date::depuisGTFS(dateTexte.data(), dateTexte.data() + dateTexte.size());
+    Heure debut(5, 0, 0);
+    auto debutChargement = chrono::steady_clock::now();
+    DonneesGTFS gtfs(date, debut, debut.add_secondes(86400));
+    gtfs.ajouterLignes(dossier + "/routes.txt");
+    gtfs.ajouterStations(dossier + "/stops.txt");
+    gtfs.ajouterServices(dossier + "/calendar_dates.txt");
+    gtfs.ajouterVoyagesDeLaDate(dossier + "/trips.txt");
+    gtfs.ajouterArretsDesVoyagesDeLaDate(dossier + "/stop_times.txt");
+    gtfs.ajouterTransferts(dossier + "/transfers.txt");
+    double chargementMs = chrono::duration<double, milli>(chrono::steady_clock::now() - debutChargement).count();
+    size_t rssChargementKo = lireMemoireKo("VmRSS");
+    cout << "Données " << dossier << " du " << date << ": " << gtfs.getNbStations() << " stations, "
+         << gtfs.getNbArrets() << " arrêts, chargées en " << chargementMs << " ms (RSS " << rssChargementKo << " ko)"
+         << endl;
+
+    //les charges: leurs distances minimales excèdent deux fois la distance de marche des paramètres, comme dans main.cpp
+    const ParametresRecherche parametres;
+    vector<unsigned int> ids;
+    for (const auto &station : gtfs.getStations()) ids.push_back(station.first);
+    const double marche = 2.1 * parametres.distanceMaxMarche;
+    mt19937 generateur(graine);
+    vector<Charge> charges;
+    charges.push_back(genererCharge("aleatoire", gtfs, ids, generateur, nbRequetes, marche, 1e9,
+                                    Heure(6, 0, 0), Heure(22, 0, 0)));
+    charges.push_back(genererCharge("longueDistance", gtfs, ids, generateur, nbRequetes, 10.0, 1e9,
+                                    Heure(6, 0, 0), Heure(22, 0, 0)));
+    charges.push_back(genererCharge("pointe", gtfs, ids, generateur, nbRequetes, marche, 1e9,
+                                    Heure(7, 0, 0), Heure(9, 0, 0)));
+    charges.push_back(genererCharge("courtsTrajets", gtfs, ids, generateur, nbRequetes, marche, 5.0,
+                                    Heure(6, 0, 0), Heure(22, 0, 0)));
+
+    vector<Moteur> moteurs;
+    stringstream flux(listeMoteurs);
+    string nom;
+    while (getline(flux, nom, ','))
+    {
+        Moteur moteur;
+        moteur.nom = nom;
+        moteur.options.nbThreads = nbThreads;
+        if (nom == "toutesLignes") {}
+        else if (nom == "chainesAttente") moteur.options.modele = ModeleTransferts::CHAINES_ATTENTE;
+        else if (nom == "toutesLignesDijkstra") moteur.options.rechercheGuidee = false;
+        else if (nom == "chainesAttenteDijkstra")
+        {
+            moteur.options.modele = ModeleTransferts::CHAINES_ATTENTE;
+            moteur.options.rechercheGuidee = false;
+        }
+        else throw logic_error("BenchReseau: moteur inconnu " + nom);
+        moteurs.push_back(moteur);
+    }
+
+    vector<ResultatMoteur> resultats;
+    cout << fixed << setprecision(1);
+    for (const Moteur &moteur : moteurs)
+    {
+        ResultatMoteur resultat;
+        resultat.moteur = moteur.nom;
+        auto debutConstruction = chrono::steady_clock::now();
+        ReseauGTFS reseau(gtfs, moteur.options);
+        resultat.constructionMs = chrono::duration<double, milli>(chrono::steady_clock::now() - debutConstruction).count();
+        resultat.rssKo = lireMemoireKo("VmRSS");
+        resultat.nbSommets = reseau.getNbSommets();
+        resultat.nbArcs = reseau.getNbArcs();
+        cout << endl << moteur.nom << ": " << resultat.nbSommets << " sommets, " << resultat.nbArcs << " arcs, construit en "
+             << resultat.constructionMs << " ms (RSS " << resultat.rssKo << " ko)" << endl;
+        cout << "  " << left << setw(16) << "charge" << right << setw(10) << "p50 (us)" << setw(10) << "p95" << setw(10)
+             << "p99" << setw(10) << "moyenne" << setw(12) << "recherche" << setw(10) << "req/s" << setw(10)
+             << "atteintes" << setw(14) << "somme (s)" << endl;
+        for (const Charge &charge : charges)
+        {
+            ResultatCharge r = executerCharge(reseau, gtfs, charge, parametres, echauffement, repetitions);
+            cout << "  " << left << setw(16) << r.charge << right << setw(10) << r.p50Us << setw(10) << r.p95Us
+                 << setw(10) << r.p99Us << setw(10) << r.moyenneUs << setw(12) << r.rechercheP50Us << setw(10)
+                 << r.requetesParSeconde << setw(10) << r.atteintes << setw(14) << r.sommeTemps << endl;
+            resultat.charges.push_back(r);
+        }
+        resultats.push_back(resultat);
+    }
+    cout << endl << "RSS maximal: " << lireMemoireKo("VmHWM") << " ko" << endl;
+
+    if (!fichierJSON.empty())
+    {
+        ofstream sortie(fichierJSON);
+        if (!sortie) throw logic_error("BenchReseau: impossible d'écrire " + fichierJSON);
+        ecrireResultatsJSON(sortie, etiquette, dossier, dateTexte, graine, nbRequetes, repetitions, chargementMs,
+                            rssChargementKo, resultats);
+    }
+    return 0;
+}
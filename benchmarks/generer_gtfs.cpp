@@ -0,0 +1,505 @@
+//
+// Générateur de données GTFS synthétiques pour mesurer le passage à l'échelle de DonneesGTFS et ReseauGTFS
+//
+// usage: GenererGTFS --sortie dossier [--echelle E] [--graine S] [--debut AAAAMMJJ] [--jours J]
+//
+// L'échelle 1 correspond à peu près au réseau du RTC (environ 80 lignes, 2000 stations desservies, 5000 voyages et
+// 150 000 arrêts un jour de semaine); l'échelle E multiplie le nombre de lignes et de pôles et la superficie
+// desservie par E, à densité constante. La géographie est formée de pôles (centres-villes) reliés par des lignes dont
+// les arrêts sont espacés de 250 à 450 mètres; les arrêts à moins de 60 mètres d'une station existante la réutilisent,
+// ce qui crée les correspondances. Les fréquences dépendent du type de ligne (métrobus, régulière, express, couche-tard)
+// et de la période (pointe, hors pointe, fin de semaine). Trois services sont produits (semaine, samedi, dimanche),
+// actifs sur J jours consécutifs à partir de la date de début dans calendar_dates.txt. Les fichiers produits sont
+// routes.txt, stops.txt, trips.txt, stop_times.txt, calendar_dates.txt, transfers.txt et agency.txt; seules les
+// colonnes lues par DonneesGTFS sont significatives, les autres sont présentes pour respecter le format du RTC.
+// Pour une même graine et une même échelle, les fichiers produits sont identiques.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+const double latitudeCentre = 46.81; //centré sur Québec, comme le RTC
+const double longitudeCentre = -71.25;
+const double kmParDegreLatitude = 110.57;
+const double pi = 3.14159265358979323846;
+
+const double distanceFusion = 0.060; //km: un arrêt plus proche d'une station existante la réutilise
+const double distanceTransfert = 0.200; //km: portée des transferts à pied de transfers.txt
+const double vitesseMarche = 1.1; //m/s, pour min_transfer_time
+
+//! \brief types de lignes, avec la couleur GTFS reconnue par Ligne::couleurToCategorie
+enum class TypeLigne {METRO_BUS, REGULIERE, EXPRESS, COUCHE_TARD};
+
+struct Station
+{
+    double x; //km vers l'est depuis le centre
+    double y; //km vers le nord depuis le centre
+};
+
+struct Ligne
+{
+    unsigned int id;
+    TypeLigne type;
+    vector<unsigned int> stations; //dans le sens aller
+};
+
+//! \brief une période de service: de debut à fin (en secondes depuis minuit), un départ toutes les intervalle secondes
+struct Periode
+{
+    unsigned int debut;
+    unsigned int fin;
+    unsigned int intervalle;
+};
+
+enum class Service {SEMAINE, SAMEDI, DIMANCHE};
+
+const char *nomService(Service p_service)
+{
+    switch (p_service)
+    {
+        case Service::SEMAINE: return "SYNTH-SEMAINE";
+        case Service::SAMEDI: return "SYNTH-SAMEDI";
+        default: return "SYNTH-DIMANCHE";
+    }
+}
+
+const char *couleur(TypeLigne p_type)
+{
+    switch (p_type)
+    {
+        case TypeLigne::METRO_BUS: return "97BF0D";
+        case TypeLigne::REGULIERE: return "013888";
+        case TypeLigne::EXPRESS: return "E04503";
+        default: return "1A171B";
+    }
+}
+
+//! \brief vitesse commerciale moyenne (km/h), arrêts compris
+double vitesse(TypeLigne p_type)
+{
+    return p_type == TypeLigne::EXPRESS ? 28.0 : p_type == TypeLigne::METRO_BUS ? 22.0 : 18.0;
+}
+
+unsigned int h(unsigned int p_heures, unsigned int p_minutes = 0)
+{
+    return p_heures * 3600 + p_minutes * 60;
+}
+
+//! \brief grille de fréquences d'une ligne pour un service
+vector<Periode> periodes(TypeLigne p_type, Service p_service)
+{
+    bool semaine = p_service == Service::SEMAINE;
+    switch (p_type)
+    {
+        case TypeLigne::METRO_BUS:
+            if (semaine)
+                return {{h(5), h(6, 30), 900}, {h(6, 30), h(9), 600}, {h(9), h(15), 900}, {h(15), h(18), 600},
+                        {h(18), h(24, 30), 1200}};
+            return {{h(6), h(24, 30), 1200}};
+        case TypeLigne::REGULIERE:
+            if (semaine)
+                return {{h(5, 30), h(6, 30), 2400}, {h(6, 30), h(9), 1200}, {h(9), h(15), 2400},
+                        {h(15), h(18), 1200}, {h(18), h(24), 2400}};
+            return {{h(7), h(23, 30), 3600}};
+        case TypeLigne::EXPRESS:
+            if (semaine) return {{h(6, 15), h(8, 45), 1800}, {h(15, 30), h(18), 1800}};
+            return {};
+        default: //les nuits de fin de semaine seulement, après minuit (heures GTFS au-delà de 24h)
+            if (p_service == Service::SAMEDI || p_service == Service::DIMANCHE) return {{h(24, 30), h(27), 1800}};
+            return {};
+    }
+}
+
+//! \brief écrit une heure au format GTFS HH:MM:SS (les heures peuvent dépasser 24)
+void ecrireHeure(string &p_tampon, unsigned int p_secondes)
+{
+    char texte[32];
+    snprintf(texte, sizeof(texte), "%02u:%02u:%02u", p_secondes / 3600, p_secondes % 3600 / 60, p_secondes % 60);
+    p_tampon += texte;
+}
+
+//! \brief nombre de jours depuis le 1970-01-01 du calendrier grégorien
+long joursDepuisEpoque(int p_an, unsigned int p_mois, unsigned int p_jour)
+{
+    p_an -= p_mois <= 2;
+    const long ere = (p_an >= 0 ? p_an : p_an - 399) / 400;
+    const unsigned int anDeLEre = static_cast<unsigned int>(p_an - ere * 400);
+    const unsigned int jourDeLAn = (153 * (p_mois > 2 ? p_mois - 3 : p_mois + 9) + 2) / 5 + p_jour - 1;
+    const unsigned int jourDeLEre = anDeLEre * 365 + anDeLEre / 4 - anDeLEre / 100 + jourDeLAn;
+    return ere * 146097 + static_cast<long>(jourDeLEre) - 719468;
+}
+
+//! \brief date AAAAMMJJ correspondant à un nombre de jours depuis le 1970-01-01
+string dateGTFS(long p_jours)
+{
+    p_jours += 719468;
+    const long ere = (p_jours >= 0 ? p_jours : p_jours - 146096) / 146097;
+    const unsigned int jourDeLEre = static_cast<unsigned int>(p_jours - ere * 146097);
+    const unsigned int anDeLEre = (jourDeLEre - jourDeLEre / 1460 + jourDeLEre / 36524 - jourDeLEre / 146096) / 365;
+    const unsigned int jourDeLAn = jourDeLEre - (365 * anDeLEre + anDeLEre / 4 - anDeLEre / 100);
+    const unsigned int mp = (5 * jourDeLAn + 2) / 153;
+    const unsigned int jour = jourDeLAn - (153 * mp + 2) / 5 + 1;
+    const unsigned int mois = mp < 10 ? mp + 3 : mp - 9;
+    const long an = static_cast<long>(anDeLEre) + ere * 400 + (mois <= 2);
+    char texte[32];
+    snprintf(texte, sizeof(texte), "%04ld%02u%02u", an, mois, jour);
+    return texte;
+}
+
+/*!
+ * \brief Grille uniforme sur le plan (cellules de distanceTransfert de côté) pour retrouver les stations voisines
+ */
+class Grille
+{
+public:
+    explicit Grille(const vector<Station> &p_stations) : m_stations(p_stations) {}
+
+    void ajouter(unsigned int p_station)
+    {
+        m_cellules[cle(cellule(m_stations[p_station].x), cellule(m_stations[p_station].y))].push_back(p_station);
+    }
+
+    //! \brief appelle p_visiter(station, distance) pour chaque station à moins de p_rayon (<= distanceTransfert) km
+    template<typename Visiteur>
+    void voisines(double p_x, double p_y, double p_rayon, Visiteur p_visiter) const
+    {
+        const long cx = cellule(p_x), cy = cellule(p_y);
+        for (long i = cx - 1; i <= cx + 1; ++i)
+        {
+            for (long j = cy - 1; j <= cy + 1; ++j)
+            {
+                auto it = m_cellules.find(cle(i, j));
+                if (it == m_cellules.end()) continue;
+                for (unsigned int s : it->second)
+                {
+                    double d = hypot(m_stations[s].x - p_x, m_stations[s].y - p_y);
+                    if (d < p_rayon) p_visiter(s, d);
+                }
+            }
+        }
+    }
+
+private:
+    const vector<Station> &m_stations;
+    unordered_map<uint64_t, vector<unsigned int>> m_cellules;
+
+    static long cellule(double p_coord) { return static_cast<long>(floor(p_coord / distanceTransfert)); }
+
+    static uint64_t cle(long p_i, long p_j)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(p_i)) << 32) | static_cast<uint32_t>(p_j);
+    }
+};
+
+/*!
+ * \brief Réseau synthétique: pôles, stations et lignes, produits à partir de l'échelle et de la graine
+ */
+class Generateur
+{
+public:
+    Generateur(double p_echelle, unsigned int p_graine) : m_echelle(p_echelle), m_alea(p_graine), m_grille(m_stations)
+    {
+        if (p_echelle <= 0) throw logic_error("GenererGTFS: l'échelle doit être positive");
+        m_rayon = 12.0 * sqrt(p_echelle);
+        genererPoles(max<size_t>(1, static_cast<size_t>(lround(6 * p_echelle))));
+        size_t nbLignes = max<size_t>(1, static_cast<size_t>(lround(80 * p_echelle)));
+        for (size_t l = 0; l < nbLignes; ++l) genererLigne(static_cast<unsigned int>(l));
+    }
+
+    void ecrire(const string &p_dossier, const string &p_debut, unsigned int p_jours) const
+    {
+        ecrireAgence(p_dossier + "/agency.txt");
+        ecrireLignes(p_dossier + "/routes.txt");
+        ecrireStations(p_dossier + "/stops.txt");
+        ecrireTransferts(p_dossier + "/transfers.txt");
+        ecrireCalendrier(p_dossier + "/calendar_dates.txt", p_debut, p_jours);
+        ecrireVoyages(p_dossier + "/trips.txt", p_dossier + "/stop_times.txt");
+    }
+
+    size_t getNbStations() const { return m_stations.size(); }
+    size_t getNbLignes() const { return m_lignes.size(); }
+
+private:
+    double m_echelle;
+    double m_rayon; //km
+    mt19937 m_alea;
+    vector<Station> m_poles;
+    vector<Station> m_stations;
+    vector<Ligne> m_lignes;
+    Grille m_grille;
+
+    double uniforme(double p_min, double p_max)
+    {
+        return uniform_real_distribution<double>(p_min, p_max)(m_alea);
+    }
+
+    //! \brief un point uniforme dans le disque desservi
+    Station pointDuDisque()
+    {
+        double r = m_rayon * sqrt(uniforme(0, 1));
+        double a = uniforme(0, 2 * pi);
+        return {r * cos(a), r * sin(a)};
+    }
+
+    void genererPoles(size_t p_nbPoles)
+    {
+        m_poles.push_back({0, 0}); //centre-ville
+        while (m_poles.size() < p_nbPoles) m_poles.push_back(pointDuDisque());
+    }
+
+    //! \brief retourne la station à moins de distanceFusion de (x, y), ou en crée une
+    unsigned int station(double p_x, double p_y)
+    {
+        unsigned int proche = static_cast<unsigned int>(m_stations.size());
+        double meilleure = distanceFusion;
+        m_grille.voisines(p_x, p_y, distanceFusion, [&](unsigned int s, double d)
+        {
+            if (d < meilleure) { meilleure = d; proche = s; }
+        });
+        if (proche == m_stations.size())
+        {
+            m_stations.push_back({p_x, p_y});
+            m_grille.ajouter(proche);
+        }
+        return proche;
+    }
+
+    //! \brief une ligne part d'un pôle (ou d'un point quelconque) vers un pôle voisin (ou un point à 4 à 14 km),
+    //! en suivant un tracé légèrement sinueux
+    void genererLigne(unsigned int p_numero)
+    {
+        Ligne ligne;
+        ligne.id = 900000 + p_numero;
+        double tirage = uniforme(0, 1);
+        ligne.type = tirage < 0.10 ? TypeLigne::METRO_BUS : tirage < 0.60 ? TypeLigne::REGULIERE :
+                                                            tirage < 0.90 ? TypeLigne::EXPRESS : TypeLigne::COUCHE_TARD;
+
+        Station depart = uniforme(0, 1) < 0.7 ? m_poles[m_alea() % m_poles.size()] : pointDuDisque();
+        Station arrivee;
+        vector<const Station *> candidats;
+        for (const auto &p : m_poles)
+        {
+            double d = hypot(p.x - depart.x, p.y - depart.y);
+            if (d > 4 && d < 14) candidats.push_back(&p);
+        }
+        if (!candidats.empty() && uniforme(0, 1) < 0.7) arrivee = *candidats[m_alea() % candidats.size()];
+        else
+        {
+            double d = uniforme(4, 14);
+            double a = uniforme(0, 2 * pi);
+            arrivee = {depart.x + d * cos(a), depart.y + d * sin(a)};
+        }
+
+        double x = depart.x, y = depart.y;
+        double cap = atan2(arrivee.y - y, arrivee.x - x);
+        ligne.stations.push_back(station(x, y));
+        double restant;
+        while ((restant = hypot(arrivee.x - x, arrivee.y - y)) > 0.45 && ligne.stations.size() < 200)
+        {
+            double vise = atan2(arrivee.y - y, arrivee.x - x);
+            cap = vise + 0.5 * remainder(cap - vise, 2 * pi) + uniforme(-0.3, 0.3);
+            double pas = min(restant, uniforme(0.25, 0.45));
+            x += pas * cos(cap);
+            y += pas * sin(cap);
+            unsigned int s = station(x, y);
+            if (s != ligne.stations.back() && find(ligne.stations.begin(), ligne.stations.end(), s) == ligne.stations.end())
+                ligne.stations.push_back(s);
+        }
+        if (ligne.stations.size() >= 2) m_lignes.push_back(ligne);
+    }
+
+    static double latitude(const Station &p_s)
+    {
+        return latitudeCentre + p_s.y / kmParDegreLatitude;
+    }
+
+    static double longitude(const Station &p_s)
+    {
+        return longitudeCentre + p_s.x / (kmParDegreLatitude * cos(latitudeCentre * pi / 180));
+    }
+
+    static ofstream ouvrir(const string &p_nomFichier)
+    {
+        ofstream fichier(p_nomFichier, ios::binary);
+        if (!fichier) throw logic_error("GenererGTFS: impossible de créer " + p_nomFichier);
+        return fichier;
+    }
+
+    void ecrireAgence(const string &p_nomFichier) const
+    {
+        ofstream fichier = ouvrir(p_nomFichier);
+        fichier << "agency_id,agency_name,agency_url,agency_timezone,agency_lang\n"
+                << "SYNTH,\"Réseau synthétique\",http://example.org,America/Montreal,fr\n";
+    }
+
+    void ecrireLignes(const string &p_nomFichier) const
+    {
+        ofstream fichier = ouvrir(p_nomFichier);
+        fichier << "route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_url,route_color,"
+                   "route_text_color\n";
+        for (const auto &l : m_lignes)
+        {
+            fichier << l.id << ",SYNTH,\"" << l.id - 900000 + 1 << "\",,\"Ligne " << l.id - 900000 + 1 << " - Station "
+                    << l.stations.front() + 1 << " / Station " << l.stations.back() + 1 << "\",3,," << couleur(l.type)
+                    << ",FFFFFF\n";
+        }
+    }
+
+    void ecrireStations(const string &p_nomFichier) const
+    {
+        ofstream fichier = ouvrir(p_nomFichier);
+        fichier << "stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,wheelchair_boarding\n";
+        char position[64];
+        for (size_t s = 0; s < m_stations.size(); ++s)
+        {
+            snprintf(position, sizeof(position), "%.6f,%.6f", latitude(m_stations[s]), longitude(m_stations[s]));
+            fichier << s + 1 << ",\"Station " << s + 1 << "\",\"Synthétique / " << s + 1 << "\"," << position
+                    << ",,0,2\n";
+        }
+    }
+
+    //! \brief transferts à pied (dans les deux sens) entre stations à moins de distanceTransfert
+    void ecrireTransferts(const string &p_nomFichier) const
+    {
+        ofstream fichier = ouvrir(p_nomFichier);
+        fichier << "from_stop_id,to_stop_id,transfer_type,min_transfer_time\n";
+        for (unsigned int s = 0; s < m_stations.size(); ++s)
+        {
+            m_grille.voisines(m_stations[s].x, m_stations[s].y, distanceTransfert, [&](unsigned int v, double d)
+            {
+                if (v == s) return;
+                unsigned int temps = max(60u, static_cast<unsigned int>(ceil(d * 1000 / vitesseMarche / 60)) * 60);
+                fichier << s + 1 << "," << v + 1 << ",2," << temps << "\n";
+            });
+        }
+    }
+
+    static Service serviceDuJour(long p_jours)
+    {
+        long jourSemaine = ((p_jours % 7) + 7 + 3) % 7; //0 = lundi (le 1970-01-01 était un jeudi)
+        return jourSemaine < 5 ? Service::SEMAINE : jourSemaine == 5 ? Service::SAMEDI : Service::DIMANCHE;
+    }
+
+    static void ecrireCalendrier(const string &p_nomFichier, const string &p_debut, unsigned int p_jours)
+    {
+        if (p_debut.size() != 8 || p_debut.find_first_not_of("0123456789") != string::npos)
+            throw logic_error("GenererGTFS: date de début invalide " + p_debut);
+        long debut = joursDepuisEpoque(stoi(p_debut.substr(0, 4)), stoul(p_debut.substr(4, 2)),
+                                       stoul(p_debut.substr(6, 2)));
+        ofstream fichier = ouvrir(p_nomFichier);
+        fichier << "service_id,date,exception_type\n";
+        for (long j = debut; j < debut + static_cast<long>(p_jours); ++j)
+            fichier << nomService(serviceDuJour(j)) << "," << dateGTFS(j) << ",1\n";
+    }
+
+    //! \brief écrit les voyages des trois services et leurs arrêts; les temps entre arrêts suivent la distance,
+    //! la vitesse du type de ligne et un ralentissement de 20% en pointe
+    void ecrireVoyages(const string &p_fichierVoyages, const string &p_fichierArrets) const
+    {
+        ofstream voyages = ouvrir(p_fichierVoyages);
+        ofstream arrets = ouvrir(p_fichierArrets);
+        voyages << "route_id,service_id,trip_id,trip_headsign,trip_short_name,direction_id,block_id,shape_id,"
+                   "wheelchair_accessible\n";
+        arrets << "trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type\n";
+        string tampon;
+        tampon.reserve(1 << 20);
+        mt19937 alea(m_alea);
+        unsigned int numeroVoyage = 0;
+        for (Service service : {Service::SEMAINE, Service::SAMEDI, Service::DIMANCHE})
+        {
+            for (const auto &l : m_lignes)
+            {
+                for (unsigned int direction = 0; direction < 2; ++direction)
+                {
+                    vector<unsigned int> parcours = l.stations;
+                    if (direction == 1) reverse(parcours.begin(), parcours.end());
+                    vector<double> troncons; //secondes entre arrêts consécutifs, hors pointe
+                    for (size_t i = 1; i < parcours.size(); ++i)
+                    {
+                        const Station &a = m_stations[parcours[i - 1]], &b = m_stations[parcours[i]];
+                        troncons.push_back(hypot(a.x - b.x, a.y - b.y) / vitesse(l.type) * 3600);
+                    }
+                    for (const Periode &p : periodes(l.type, service))
+                    {
+                        unsigned int decalage = alea() % min(p.intervalle, 600u);
+                        for (unsigned int t = p.debut + decalage; t < p.fin; t += p.intervalle)
+                        {
+                            string idVoyage = to_string(++numeroVoyage) + "-" + nomService(service);
+                            voyages << l.id << "," << nomService(service) << "," << idVoyage << ",\"Station "
+                                    << parcours.back() + 1 << "\",," << direction << ",,," << 2 << "\n";
+                            bool pointe = service == Service::SEMAINE &&
+                                          ((t >= h(6, 30) && t < h(9)) || (t >= h(15) && t < h(18)));
+                            double heure = t;
+                            for (size_t i = 0; i < parcours.size(); ++i)
+                            {
+                                if (i > 0) heure += troncons[i - 1] * (pointe ? 1.2 : 1.0);
+                                unsigned int secondes = static_cast<unsigned int>(lround(heure));
+                                tampon += idVoyage;
+                                tampon += ',';
+                                ecrireHeure(tampon, secondes);
+                                tampon += ',';
+                                ecrireHeure(tampon, secondes);
+                                tampon += ',';
+                                tampon += to_string(parcours[i] + 1);
+                                tampon += ',';
+                                tampon += to_string(i + 1);
+                                tampon += ",0,0\n";
+                            }
+                            if (tampon.size() > (1 << 20) - 4096)
+                            {
+                                arrets.write(tampon.data(), static_cast<streamsize>(tampon.size()));
+                                tampon.clear();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        arrets.write(tampon.data(), static_cast<streamsize>(tampon.size()));
+        if (!voyages || !arrets) throw logic_error("GenererGTFS: erreur d'écriture de " + p_fichierArrets);
+    }
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+    string dossier;
+    double echelle = 1;
+    unsigned int graine = 2018;
+    string debut = "20180801";
+    unsigned int jours = 122;
+    for (int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (i + 1 >= argc) throw logic_error("GenererGTFS: valeur manquante pour " + option);
+        string valeur = argv[++i];
+        if (option == "--sortie") dossier = valeur;
+        else if (option == "--echelle") echelle = strtod(valeur.c_str(), nullptr);
+        else if (option == "--graine") graine = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else if (option == "--debut") debut = valeur;
+        else if (option == "--jours") jours = (unsigned int) strtoul(valeur.c_str(), nullptr, 10);
+        else throw logic_error("GenererGTFS: option inconnue " + option);
+    }
+    if (dossier.empty()) throw logic_error("GenererGTFS: --sortie dossier est obligatoire");
+
+    Generateur generateur(echelle, graine);
+    generateur.ecrire(dossier, debut, jours);
+    cout << "Échelle " << echelle << ": " << generateur.getNbLignes() << " lignes, " << generateur.getNbStations()
+         << " stations écrites dans " << dossier << endl;
+    return 0;
+}
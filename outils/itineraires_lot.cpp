@@ -0,0 +1,347 @@
+//
+// Calcul d'itinéraires en lot, de l'entrée standard vers la sortie standard
+//
+// usage: ItinerairesLot [--gtfs dossier] [--date AAAAMMJJ] [--debut HH:MM:SS] [--travailleurs N] [--fenetre F]
+//                       [--modele toutesLignes|chainesAttente] [--format csv|json] [--vitesse km/h] [--marcheMax km]
+//                       [--correspondancesMax K] [--penalite secondes] < requetes.csv > itineraires.csv
+//
+// Chaque ligne de l'entrée est une requête "LAT,LON,LAT,LON,HH:MM:SS" (origine, destination, heure de départ); les lignes
+// vides, celles qui commencent par '#' et une première ligne d'en-tête non numérique sont ignorées. Les options --vitesse,
+// --marcheMax, --correspondancesMax et --penalite donnent les paramètres de recherche (voir ParametresRecherche) de
+// toutes les requêtes; une option invalide ou hors de ses bornes (voir main()) termine le programme avant tout calcul.
+// Chaque requête produit une ligne de sortie, dans l'ordre de l'entrée, même si les N travailleurs
+// les terminent dans le désordre:
+//   csv:  no,atteignable,heureDepart,heureArrivee,duree,autobus,erreur   (no = numéro de la ligne d'entrée)
+//   json: un objet par ligne (voir ecrireJSON()), avec "no" et, le cas échéant, "erreur"
+// Au plus F requêtes sont en mémoire à la fois, lues mais pas encore écrites: la lecture attend l'écriture lorsque la
+// fenêtre est pleine, de sorte que la mémoire ne dépend pas de la taille de l'entrée. Le débit est écrit sur stderr à la fin.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "reseauPartage.h"
+
+using namespace std;
+
+namespace
+{
+
+enum class Format {CSV, JSON};
+
+const char *usage = "usage: ItinerairesLot [--gtfs dossier] [--date AAAAMMJJ] [--debut HH:MM:SS] [--travailleurs N] "
+                    "[--fenetre F] [--modele toutesLignes|chainesAttente] [--format csv|json] [--vitesse km/h] "
+                    "[--marcheMax km] [--correspondancesMax K] [--penalite secondes] < requetes.csv";
+
+//bornes des options (voir main())
+const double vitesseMarcheMax = 20.0; //km/h
+const double distanceMarcheMax = 5.0; //km
+const unsigned int correspondancesMaxLimite = 100;
+const unsigned int penaliteMax = 3600; //secondes par correspondance
+const unsigned int travailleursMax = 1024;
+const size_t fenetreMax = 1 << 20; //requêtes en mémoire
+
+//! \brief une requête de la fenêtre: la ligne lue, puis la ligne de sortie calculée par un travailleur
+struct Case
+{
+    size_t no = 0; //numéro de la ligne d'entrée
+    string requete;
+    string resultat;
+    bool pret = false;
+};
+
+/*!
+ * \brief Fenêtre circulaire des requêtes lues mais pas encore écrites
+ * Les requêtes reçoivent des rangs consécutifs à la lecture: le lecteur attend qu'une case soit libre (rang - écrites < F),
+ * les travailleurs prennent le plus petit rang non attribué, et l'écrivain attend que la requête du rang suivant soit prête.
+ */
+class Fenetre
+{
+
+public:
+    explicit Fenetre(size_t p_capacite) : m_cases(p_capacite)
+    {
+    }
+
+    //! \brief lecteur: ajoute une requête, en attendant au besoin qu'une case se libère
+    void deposer(size_t p_no, string p_requete)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_caseLibre.wait(verrou, [this] { return m_lues - m_ecrites < m_cases.size(); });
+        Case &c = m_cases[m_lues % m_cases.size()];
+        c.no = p_no;
+        c.requete = move(p_requete);
+        c.pret = false;
+        ++m_lues;
+        m_requeteLue.notify_one();
+    }
+
+    //! \brief lecteur: signale la fin de l'entrée
+    void terminer()
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        m_finEntree = true;
+        m_requeteLue.notify_all();
+        m_resultatPret.notify_all();
+    }
+
+    //! \brief travailleur: attribue la prochaine requête non attribuée
+    //! \return false si l'entrée est terminée et toutes ses requêtes attribuées
+    bool prendre(size_t &p_rang, size_t &p_no, string &p_requete)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_requeteLue.wait(verrou, [this] { return m_attribuees < m_lues || m_finEntree; });
+        if (m_attribuees == m_lues) return false;
+        p_rang = m_attribuees++;
+        const Case &c = m_cases[p_rang % m_cases.size()];
+        p_no = c.no;
+        p_requete = c.requete;
+        return true;
+    }
+
+    //! \brief travailleur: dépose la ligne de sortie de la requête de rang p_rang
+    void rendre(size_t p_rang, string p_resultat)
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        Case &c = m_cases[p_rang % m_cases.size()];
+        c.resultat = move(p_resultat);
+        c.pret = true;
+        if (p_rang == m_ecrites) m_resultatPret.notify_one();
+    }
+
+    //! \brief écrivain: attend la ligne de sortie de la requête suivante, dans l'ordre de l'entrée
+    //! \return false si toutes les requêtes ont été écrites et l'entrée est terminée
+    bool retirer(string &p_resultat)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_resultatPret.wait(verrou, [this]
+        {
+            return (m_ecrites < m_lues && m_cases[m_ecrites % m_cases.size()].pret) || (m_finEntree && m_ecrites == m_lues);
+        });
+        if (m_ecrites == m_lues) return false;
+        Case &c = m_cases[m_ecrites % m_cases.size()];
+        p_resultat.swap(c.resultat);
+        c.requete.clear();
+        ++m_ecrites;
+        m_caseLibre.notify_one();
+        return true;
+    }
+
+private:
+    mutex m_mutex;
+    condition_variable m_caseLibre;
+    condition_variable m_requeteLue;
+    condition_variable m_resultatPret;
+    vector<Case> m_cases;
+    size_t m_lues = 0; //rangs [0, m_lues) lus
+    size_t m_attribuees = 0; //rangs [0, m_attribuees) pris par un travailleur
+    size_t m_ecrites = 0; //rangs [0, m_ecrites) écrits; la case du rang r est m_cases[r % capacité]
+    bool m_finEntree = false;
+};
+
+double lireNombre(const string &p_texte)
+{
+    char *fin = nullptr;
+    double valeur = strtod(p_texte.c_str(), &fin);
+    if (p_texte.empty() || *fin != '\0') throw logic_error("nombre invalide: " + p_texte);
+    return valeur;
+}
+
+//une première ligne dont le premier champ n'est pas un nombre est un en-tête
+bool estEntete(const string &p_ligne)
+{
+    string premier = p_ligne.substr(0, p_ligne.find(','));
+    char *fin = nullptr;
+    strtod(premier.c_str(), &fin);
+    return premier.empty() || *fin != '\0';
+}
+
+//! \brief compteurs partagés par les travailleurs
+struct Compteurs
+{
+    atomic<uint64_t> requetes{0};
+    atomic<uint64_t> erreurs{0}; //lignes invalides
+    atomic<uint64_t> nonAtteignables{0};
+    atomic<uint64_t> microsecondesRecherche{0}; //somme des temps de calcul des itinéraires
+};
+
+//calcule l'itinéraire d'une ligne d'entrée et retourne sa ligne de sortie (sans fin de ligne)
+string traiter(const VersionReseau &p_version, const ParametresRecherche &p_parametres, size_t p_no,
+               const string &p_requete, Format p_format, Compteurs &p_compteurs)
+{
+    ostringstream sortie;
+    ++p_compteurs.requetes;
+    try
+    {
+        vector<string> champs = DonneesGTFS::string_to_vector(p_requete, ',');
+        if (champs.size() != 5) throw logic_error("ligne attendue: LAT,LON,LAT,LON,HH:MM:SS");
+        Coordonnees origine(lireNombre(champs[0]), lireNombre(champs[1]));
+        Coordonnees destination(lireNombre(champs[2]), lireNombre(champs[3]));
+        Heure depart = DonneesGTFS::stringToHeure(champs[4]);
+
+        auto debut = chrono::steady_clock::now();
+        long tempsExecution;
+        Itineraire resultat = p_version.getReseau().calculerItineraire(p_version.getDonnees(), origine, destination,
+                                                                       depart, p_parametres, tempsExecution);
+        p_compteurs.microsecondesRecherche += (uint64_t) chrono::duration_cast<chrono::microseconds>(
+                chrono::steady_clock::now() - debut).count();
+        if (!resultat.atteignable) ++p_compteurs.nonAtteignables;
+
+        if (p_format == Format::JSON)
+        {
+            //l'objet de ecrireJSON(), précédé du numéro de ligne
+            ostringstream objet;
+            ecrireJSON(objet, resultat);
+            sortie << "{\"no\": " << p_no << ", " << objet.str().substr(1);
+        }
+        else
+        {
+            size_t autobus = count_if(resultat.etapes.begin(), resultat.etapes.end(),
+                                      [](const EtapeItineraire &e) { return e.type == TypeEtape::AUTOBUS; });
+            sortie << p_no << "," << (resultat.atteignable ? 1 : 0) << "," << resultat.heureDepart << ",";
+            if (resultat.atteignable) sortie << resultat.heureArrivee << "," << resultat.duree << "," << autobus << ",";
+            else sortie << ",,,";
+        }
+    }
+    catch (const logic_error &e)
+    {
+        ++p_compteurs.erreurs;
+        sortie.str("");
+        if (p_format == Format::JSON)
+        {
+            sortie << "{\"no\": " << p_no << ", \"erreur\": ";
+            ecrireChaineJSON(sortie, e.what());
+            sortie << "}";
+        }
+        else
+        {
+            string message = e.what();
+            replace(message.begin(), message.end(), ',', ';');
+            sortie << p_no << ",0,,,,," << message;
+        }
+    }
+    return sortie.str();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    SourceGTFS source;
+    string dateTexte = "20180921";
+    string debutTexte = "07:30:00";
+    unsigned int nbTravailleurs = 0;
+    size_t tailleFenetre = 0;
+    Format format = Format::CSV;
+    ParametresRecherche parametres;
+    //une option invalide est signalée avant le chargement du GTFS: aucune valeur n'est remplacée silencieusement
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            string option = argv[i];
+            if (i + 1 >= argc) throw logic_error("valeur manquante pour " + option);
+            string valeur = argv[++i];
+            if (option == "--gtfs") source.dossier = valeur;
+            else if (option == "--date") dateTexte = valeur;
+            else if (option == "--debut") debutTexte = valeur;
+            else if (option == "--travailleurs")
+                nbTravailleurs = (unsigned int) lireEntierBorne(option, valeur, 0, travailleursMax);
+            else if (option == "--fenetre") tailleFenetre = lireEntierBorne(option, valeur, 0, fenetreMax);
+            else if (option == "--modele")
+            {
+                if (valeur == "toutesLignes") source.options.modele = ModeleTransferts::TOUTES_LIGNES;
+                else if (valeur == "chainesAttente") source.options.modele = ModeleTransferts::CHAINES_ATTENTE;
+                else throw logic_error("modèle inconnu " + valeur);
+            }
+            else if (option == "--format")
+            {
+                if (valeur == "csv") format = Format::CSV;
+                else if (valeur == "json") format = Format::JSON;
+                else throw logic_error("format inconnu " + valeur);
+            }
+            else if (option == "--vitesse")
+                parametres.vitesseMarche = lireReelBorne(option, valeur, 0, true, vitesseMarcheMax);
+            else if (option == "--marcheMax")
+                parametres.distanceMaxMarche = lireReelBorne(option, valeur, 0, false, distanceMarcheMax);
+            else if (option == "--correspondancesMax")
+                parametres.correspondancesMax =
+                        (unsigned int) lireEntierBorne(option, valeur, 0, correspondancesMaxLimite);
+            else if (option == "--penalite")
+                parametres.penaliteCorrespondance = (unsigned int) lireEntierBorne(option, valeur, 0, penaliteMax);
+            else throw logic_error("option inconnue " + option);
+        }
+
+        //comme main(): les arrêts de la journée qui suit l'heure de début
+        source.date = Date::depuisGTFS(dateTexte.data(), dateTexte.data() + dateTexte.size());
+        source.debut = DonneesGTFS::stringToHeure(debutTexte);
+        source.fin = source.debut.add_secondes(86400);
+    }
+    catch (const logic_error &e)
+    {
+        cerr << "ItinerairesLot: " << e.what() << "\n" << usage << endl;
+        return 2;
+    }
+    if (nbTravailleurs == 0) nbTravailleurs = max(1u, thread::hardware_concurrency());
+    if (tailleFenetre == 0) tailleFenetre = 64 * nbTravailleurs;
+
+    auto debutChargement = chrono::steady_clock::now();
+    VersionReseau version(source);
+    cerr << "Réseau construit en " << chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - debutChargement).count() << " ms" << endl;
+
+    ios::sync_with_stdio(false);
+    Fenetre fenetre(tailleFenetre);
+    Compteurs compteurs;
+    auto debutLot = chrono::steady_clock::now();
+
+    vector<thread> travailleurs;
+    for (unsigned int t = 0; t < nbTravailleurs; ++t)
+        travailleurs.emplace_back([&]
+        {
+            size_t rang, no;
+            string requete;
+            while (fenetre.prendre(rang, no, requete))
+                fenetre.rendre(rang, traiter(version, parametres, no, requete, format, compteurs));
+        });
+    thread ecrivain([&]
+    {
+        if (format == Format::CSV) cout << "no,atteignable,heureDepart,heureArrivee,duree,autobus,erreur\n";
+        string resultat;
+        while (fenetre.retirer(resultat)) cout << resultat << '\n';
+        cout.flush();
+    });
+
+    string ligne;
+    size_t no = 0;
+    while (getline(cin, ligne))
+    {
+        ++no;
+        if (!ligne.empty() && ligne.back() == '\r') ligne.pop_back();
+        if (ligne.empty() || ligne[0] == '#' || (no == 1 && estEntete(ligne))) continue;
+        fenetre.deposer(no, move(ligne));
+    }
+    fenetre.terminer();
+    for (auto &t : travailleurs) t.join();
+    ecrivain.join();
+
+    double secondes = chrono::duration<double>(chrono::steady_clock::now() - debutLot).count();
+    uint64_t nbCalculees = compteurs.requetes - compteurs.erreurs;
+    cerr << compteurs.requetes << " requêtes (" << compteurs.erreurs << " invalides, " << compteurs.nonAtteignables
+         << " non atteignables) en " << secondes << " s avec " << nbTravailleurs << " travailleurs: "
+         << (secondes > 0 ? compteurs.requetes / secondes : 0) << " requêtes/s";
+    if (nbCalculees > 0) cerr << ", " << compteurs.microsecondesRecherche / nbCalculees / 1000.0 << " ms par recherche";
+    cerr << endl;
+    return 0;
+}
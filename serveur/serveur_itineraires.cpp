@@ -0,0 +1,823 @@
+//
+// Serveur HTTP local de calcul d'itinéraires
+//
+// usage: ServeurItineraires [--gtfs dossier] [--date AAAAMMJJ] [--debut HH:MM:SS] [--port P] [--travailleurs N]
+//                           [--lot B] [--modele toutesLignes|chainesAttente]
+//
+// Le GTFS est chargé une seule fois (voir ReseauPartage); le serveur écoute ensuite sur 127.0.0.1 seulement.
+// Un seul fil accepte les connexions et lit leurs requêtes sans bloquer (poll()): seule une requête complète est placée
+// dans une file, de sorte qu'un client lent ne retarde que lui-même. Chacun des N travailleurs en retire jusqu'à B à la
+// fois (un lot), obtient une seule fois la version courante du réseau pour tout le lot, puis répond à chaque requête.
+// Les recherches passent par ReseauGTFS::calculerItineraire(..., heureDepart, ...), qui ne modifie pas le réseau:
+// les travailleurs interrogent donc le même réseau en parallèle. Une connexion porte une seule requête.
+//
+// Points d'accès:
+//   GET  /itineraire?origine=LAT,LON&destination=LAT,LON&depart=HH:MM:SS    un itinéraire (objet JSON, voir ecrireJSON())
+//   POST /itineraires    corps: une requête "LAT,LON,LAT,LON,HH:MM:SS" par ligne; un tableau JSON, dans l'ordre des lignes
+//   Les deux acceptent les paramètres de recherche (voir ParametresRecherche) dans la cible, tous facultatifs:
+//   vitesse (km/h), marcheMax (km), correspondancesMax et penalite (secondes par correspondance); une valeur invalide
+//   ou hors des bornes (voir lireParametres()) donne une réponse 400, de même qu'une heure de départ hors de l'intervalle
+//   des données chargées (dans un lot, la ligne fautive reçoit plutôt un objet {"erreur": ...})
+//   GET  /metrics        compteurs et histogrammes de latence (format texte de Prometheus)
+//   GET  /sante          version du réseau servie et état du rechargement
+//   POST /recharger      relit le GTFS en arrière-plan et publie le nouveau réseau sans interrompre le service
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "reseauPartage.h"
+
+using namespace std;
+
+namespace
+{
+
+const size_t tailleMaxEntete = 16 * 1024; //octets
+const size_t tailleMaxCorps = 1024 * 1024; //octets
+const int delaiSecondes = 5; //une connexion muette (ou qui ne lit pas sa réponse) plus longtemps est abandonnée
+const int requeteIncomplete = -1; //voir analyserRequete()
+const int connexionFermee = -2; //fermée (ou muette) sans avoir rien envoyé: elle est fermée sans réponse
+
+const char *usage = "usage: ServeurItineraires [--gtfs dossier] [--date AAAAMMJJ] [--debut HH:MM:SS] [--port P] "
+                    "[--travailleurs N] [--lot B] [--modele toutesLignes|chainesAttente]";
+const unsigned int travailleursMax = 1024;
+const size_t tailleLotMax = 1024;
+
+//bornes des paramètres de recherche acceptés (voir lireParametres())
+const double vitesseMarcheMax = 20.0; //km/h
+const double distanceMarcheMax = 5.0; //km; au-delà, une seule requête relierait une grande partie du réseau
+const unsigned int correspondancesMaxLimite = 100;
+const unsigned int penaliteMax = 3600; //secondes par correspondance
+
+volatile sig_atomic_t arretDemande = 0;
+
+void demanderArret(int)
+{
+    arretDemande = 1;
+}
+
+/*!
+ * \brief Histogramme à bornes fixes, mis à jour sans verrou par plusieurs fils d'exécution
+ */
+class Histogramme
+{
+
+public:
+    explicit Histogramme(vector<uint64_t> p_bornes)
+            : m_bornes(move(p_bornes)), m_comptes(new atomic<uint64_t>[m_bornes.size() + 1]), m_nb(0), m_somme(0)
+    {
+        for (size_t i = 0; i <= m_bornes.size(); ++i) m_comptes[i] = 0;
+    }
+
+    void ajouter(uint64_t p_valeur)
+    {
+        size_t i = lower_bound(m_bornes.begin(), m_bornes.end(), p_valeur) - m_bornes.begin();
+        ++m_comptes[i];
+        ++m_nb;
+        m_somme += p_valeur;
+    }
+
+    //écrit l'histogramme au format texte de Prometheus (compteurs cumulatifs par borne supérieure)
+    void ecrire(ostream &p_flux, const string &p_nom, const string &p_aide) const
+    {
+        p_flux << "# HELP " << p_nom << " " << p_aide << "\n# TYPE " << p_nom << " histogram\n";
+        uint64_t cumul = 0;
+        for (size_t i = 0; i < m_bornes.size(); ++i)
+        {
+            cumul += m_comptes[i];
+            p_flux << p_nom << "_bucket{le=\"" << m_bornes[i] << "\"} " << cumul << "\n";
+        }
+        cumul += m_comptes[m_bornes.size()];
+        p_flux << p_nom << "_bucket{le=\"+Inf\"} " << cumul << "\n";
+        p_flux << p_nom << "_sum " << m_somme << "\n" << p_nom << "_count " << m_nb << "\n";
+    }
+
+private:
+    vector<uint64_t> m_bornes; //bornes supérieures (incluses), croissantes
+    unique_ptr<atomic<uint64_t>[]> m_comptes; //m_comptes[i]: valeurs dans (m_bornes[i - 1], m_bornes[i]]; le dernier: au-delà
+    atomic<uint64_t> m_nb;
+    atomic<uint64_t> m_somme;
+};
+
+//bornes des histogrammes de durées, en microsecondes
+vector<uint64_t> bornesMicrosecondes()
+{
+    return {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000};
+}
+
+//! \brief mesures du serveur, exposées par /metrics
+struct Metriques
+{
+    Histogramme latence{bornesMicrosecondes()}; //de l'acceptation de la connexion à l'envoi de la réponse
+    Histogramme attente{bornesMicrosecondes()}; //d'une requête lue, dans la file avant qu'un travailleur la retire
+    Histogramme recherche{bornesMicrosecondes()}; //calcul d'un itinéraire (ReseauGTFS::calculerItineraire())
+    Histogramme tailleLot{{1, 2, 4, 8, 16, 32, 64}}; //requêtes retirées de la file à la fois
+    atomic<uint64_t> connexionsEnLecture{0}; //connexions acceptées dont la requête n'est pas encore complète
+    atomic<uint64_t> reponses2xx{0};
+    atomic<uint64_t> reponses4xx{0};
+    atomic<uint64_t> reponses5xx{0};
+    atomic<uint64_t> itineraires{0}; //itinéraires calculés (une requête /itineraires en compte plusieurs)
+};
+
+//! \brief une requête HTTP, réduite à ce que le serveur utilise
+struct RequeteHTTP
+{
+    string methode;
+    string chemin;
+    string parametres; //la partie suivant '?' dans la cible
+    string corps;
+};
+
+//! \brief une connexion acceptée dont la requête n'est pas encore complète
+struct ConnexionEnLecture
+{
+    int descripteur;
+    chrono::steady_clock::time_point acceptation;
+    chrono::steady_clock::time_point derniereReception; //la connexion est abandonnée après delaiSecondes sans octet
+    string donnees; //les octets reçus
+};
+
+//! \brief une connexion dont la requête est lue, en attente d'un travailleur
+struct Connexion
+{
+    int descripteur;
+    chrono::steady_clock::time_point acceptation;
+    chrono::steady_clock::time_point lecture; //fin de la lecture de la requête, et entrée dans la file
+    int erreur; //0 si requete est complète, sinon le code HTTP de l'erreur de lecture
+    RequeteHTTP requete;
+};
+
+/*!
+ * \brief File des connexions dont la requête est lue, partagée entre le fil de lecture et les travailleurs
+ */
+class FileConnexions
+{
+
+public:
+    void ajouter(Connexion p_connexion)
+    {
+        {
+            lock_guard<mutex> verrou(m_mutex);
+            m_connexions.push_back(move(p_connexion));
+        }
+        m_condition.notify_one();
+    }
+
+    //! \brief attend au moins une connexion et en retire jusqu'à p_max
+    //! \return false si la file est fermée et vide
+    bool retirerLot(size_t p_max, vector<Connexion> &p_lot)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_condition.wait(verrou, [this] { return m_fermee || !m_connexions.empty(); });
+        p_lot.clear();
+        while (!m_connexions.empty() && p_lot.size() < p_max)
+        {
+            p_lot.push_back(move(m_connexions.front()));
+            m_connexions.pop_front();
+        }
+        return !p_lot.empty();
+    }
+
+    void fermer()
+    {
+        {
+            lock_guard<mutex> verrou(m_mutex);
+            m_fermee = true;
+        }
+        m_condition.notify_all();
+    }
+
+    size_t taille()
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        return m_connexions.size();
+    }
+
+private:
+    mutex m_mutex;
+    condition_variable m_condition;
+    deque<Connexion> m_connexions;
+    bool m_fermee = false;
+};
+
+//! \brief une réponse HTTP
+struct ReponseHTTP
+{
+    int code = 200;
+    string type = "application/json";
+    string corps;
+};
+
+const char *raisonHTTP(int p_code)
+{
+    switch (p_code)
+    {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Internal Server Error";
+    }
+}
+
+ReponseHTTP reponseErreur(int p_code, const string &p_message)
+{
+    ReponseHTTP reponse;
+    reponse.code = p_code;
+    ostringstream corps;
+    corps << "{\"erreur\": ";
+    ecrireChaineJSON(corps, p_message);
+    corps << "}";
+    reponse.corps = corps.str();
+    return reponse;
+}
+
+//! \brief analyse les octets reçus d'une connexion
+//! \return 0 si p_donnees contient une requête complète (en-tête, puis corps selon Content-Length), requeteIncomplete
+//! s'il faut attendre d'autres octets, sinon le code HTTP de l'erreur
+int analyserRequete(const string &p_donnees, RequeteHTTP &p_requete)
+{
+    size_t finEntete = p_donnees.find("\r\n\r\n");
+    if (finEntete == string::npos) return p_donnees.size() > tailleMaxEntete ? 413 : requeteIncomplete;
+
+    istringstream entete(p_donnees.substr(0, finEntete));
+    string ligne;
+    getline(entete, ligne);
+    istringstream premiereLigne(ligne);
+    string cible;
+    if (!(premiereLigne >> p_requete.methode >> cible)) return 400;
+    size_t interrogation = cible.find('?');
+    p_requete.chemin = cible.substr(0, interrogation);
+    p_requete.parametres = interrogation == string::npos ? "" : cible.substr(interrogation + 1);
+
+    size_t longueurCorps = 0;
+    while (getline(entete, ligne))
+    {
+        size_t deuxPoints = ligne.find(':');
+        if (deuxPoints == string::npos) continue;
+        string nom = ligne.substr(0, deuxPoints);
+        transform(nom.begin(), nom.end(), nom.begin(), [](unsigned char c) { return (char) tolower(c); });
+        if (nom != "content-length") continue;
+        string valeur = ligne.substr(deuxPoints + 1);
+        valeur.erase(0, valeur.find_first_not_of(" \t"));
+        valeur.erase(valeur.find_last_not_of(" \t\r") + 1);
+        try
+        {
+            longueurCorps = lireEntierBorne("Content-Length", valeur, 0, numeric_limits<unsigned long>::max());
+        }
+        catch (const logic_error &)
+        {
+            return 400;
+        }
+    }
+    if (longueurCorps > tailleMaxCorps) return 413;
+    if (p_donnees.size() - (finEntete + 4) < longueurCorps) return requeteIncomplete;
+    p_requete.corps = p_donnees.substr(finEntete + 4, longueurCorps);
+    return 0;
+}
+
+void envoyerReponse(int p_descripteur, const ReponseHTTP &p_reponse)
+{
+    ostringstream message;
+    message << "HTTP/1.1 " << p_reponse.code << " " << raisonHTTP(p_reponse.code) << "\r\n"
+            << "Content-Type: " << p_reponse.type << "\r\n"
+            << "Content-Length: " << p_reponse.corps.size() << "\r\n"
+            << "Connection: close\r\n\r\n" << p_reponse.corps;
+    string texte = message.str();
+    size_t envoyes = 0;
+    while (envoyes < texte.size())
+    {
+        ssize_t n = send(p_descripteur, texte.data() + envoyes, texte.size() - envoyes, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        envoyes += (size_t) n;
+    }
+}
+
+//décode les %XX et les + d'un paramètre d'URL
+string decoderURL(const string &p_texte)
+{
+    string resultat;
+    for (size_t i = 0; i < p_texte.size(); ++i)
+    {
+        if (p_texte[i] == '+') resultat += ' ';
+        else if (p_texte[i] == '%' && i + 2 < p_texte.size() && isxdigit((unsigned char) p_texte[i + 1])
+                 && isxdigit((unsigned char) p_texte[i + 2]))
+        {
+            resultat += (char) strtol(p_texte.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        }
+        else resultat += p_texte[i];
+    }
+    return resultat;
+}
+
+//! \brief retourne la valeur (décodée) d'un paramètre de la cible, ou une chaîne vide s'il est absent
+string parametre(const string &p_parametres, const string &p_nom)
+{
+    for (const string &paire : DonneesGTFS::string_to_vector(p_parametres, '&'))
+    {
+        size_t egal = paire.find('=');
+        if (egal != string::npos && decoderURL(paire.substr(0, egal)) == p_nom) return decoderURL(paire.substr(egal + 1));
+    }
+    return "";
+}
+
+/*!
+ * \brief Erreur dans les données fournies par le client (réponse 400); toute autre exception donne une réponse 500
+ */
+class ErreurRequete : public logic_error
+{
+
+public:
+    using logic_error::logic_error;
+};
+
+//lit un nombre fini
+double lireNombre(const string &p_texte)
+{
+    char *fin = nullptr;
+    double valeur = strtod(p_texte.c_str(), &fin);
+    if (p_texte.empty() || *fin != '\0' || !isfinite(valeur)) throw ErreurRequete("nombre invalide: " + p_texte);
+    return valeur;
+}
+
+//lit un entier de [0, p_max], sans signe ni exposant (voir lireEntierBorne())
+unsigned int lireEntier(const string &p_nom, const string &p_texte, unsigned int p_max)
+{
+    try
+    {
+        return (unsigned int) lireEntierBorne(p_nom, p_texte, 0, p_max);
+    }
+    catch (const logic_error &e)
+    {
+        throw ErreurRequete(e.what());
+    }
+}
+
+//lit un nombre fini de [p_min, p_max], p_min exclu si p_minExclu (voir lireReelBorne())
+double lireNombreBorne(const string &p_nom, const string &p_texte, double p_min, bool p_minExclu, double p_max)
+{
+    try
+    {
+        return lireReelBorne(p_nom, p_texte, p_min, p_minExclu, p_max);
+    }
+    catch (const logic_error &e)
+    {
+        throw ErreurRequete(e.what());
+    }
+}
+
+//lit des coordonnées "LAT,LON"
+Coordonnees lireCoordonnees(const string &p_latitude, const string &p_longitude)
+{
+    double latitude = lireNombre(p_latitude);
+    double longitude = lireNombre(p_longitude);
+    if (!Coordonnees::is_valide_coord(latitude, longitude))
+        throw ErreurRequete("coordonnées invalides: " + p_latitude + "," + p_longitude);
+    return Coordonnees(latitude, longitude);
+}
+
+Coordonnees lireCoordonnees(const string &p_texte)
+{
+    vector<string> champs = DonneesGTFS::string_to_vector(p_texte, ',');
+    if (champs.size() != 2) throw ErreurRequete("coordonnées attendues sous la forme LAT,LON: " + p_texte);
+    return lireCoordonnees(champs[0], champs[1]);
+}
+
+//lit une heure de départ "HH:MM:SS", qui doit être dans l'intervalle [début, fin) des arrêts chargés
+Heure lireDepart(const string &p_texte, const DonneesGTFS &p_donnees)
+{
+    Heure depart;
+    try
+    {
+        depart = DonneesGTFS::stringToHeure(p_texte);
+    }
+    catch (const logic_error &e)
+    {
+        throw ErreurRequete(e.what());
+    }
+    if (depart < p_donnees.getTempsDebut() || !(depart < p_donnees.getTempsFin()))
+    {
+        ostringstream message;
+        message << "heure de départ hors de l'intervalle des données [" << p_donnees.getTempsDebut() << ", "
+                << p_donnees.getTempsFin() << "): " << p_texte;
+        throw ErreurRequete(message.str());
+    }
+    return depart;
+}
+
+//! \brief lit les paramètres de recherche de la cible; ceux qui sont absents gardent leur valeur par défaut
+//! \throws ErreurRequete si une valeur n'est pas un nombre ou sort de ses bornes: vitesse dans ]0, vitesseMarcheMax],
+//! marcheMax dans [0, distanceMarcheMax], correspondancesMax et penalite entiers d'au plus correspondancesMaxLimite et
+//! penaliteMax
+ParametresRecherche lireParametres(const string &p_parametres)
+{
+    ParametresRecherche parametres;
+    string valeur;
+    if (!(valeur = parametre(p_parametres, "vitesse")).empty())
+        parametres.vitesseMarche = lireNombreBorne("vitesse", valeur, 0, true, vitesseMarcheMax);
+    if (!(valeur = parametre(p_parametres, "marcheMax")).empty())
+        parametres.distanceMaxMarche = lireNombreBorne("marcheMax", valeur, 0, false, distanceMarcheMax);
+    if (!(valeur = parametre(p_parametres, "correspondancesMax")).empty())
+        parametres.correspondancesMax = lireEntier("correspondancesMax", valeur, correspondancesMaxLimite);
+    if (!(valeur = parametre(p_parametres, "penalite")).empty())
+        parametres.penaliteCorrespondance = lireEntier("penalite", valeur, penaliteMax);
+    return parametres;
+}
+
+uint64_t microsecondesDepuis(chrono::steady_clock::time_point p_debut)
+{
+    return (uint64_t) chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - p_debut).count();
+}
+
+/*!
+ * \brief Le serveur: la file des connexions, les travailleurs et le traitement des requêtes
+ */
+class Serveur
+{
+
+public:
+    Serveur(ReseauPartage &p_reseau, const SourceGTFS &p_source, size_t p_tailleLot)
+            : m_reseau(p_reseau), m_source(p_source), m_tailleLot(p_tailleLot)
+    {
+    }
+
+    void demarrer(unsigned int p_nbTravailleurs)
+    {
+        for (unsigned int t = 0; t < p_nbTravailleurs; ++t) m_travailleurs.emplace_back([this] { travailler(); });
+    }
+
+    //! \brief accepte les connexions et lit leurs requêtes, jusqu'à ce qu'un arrêt soit demandé
+    //! \brief Une connexion n'est confiée aux travailleurs qu'une fois sa requête complète (ou invalide); une connexion
+    //! \brief muette pendant delaiSecondes est abandonnée. Les connexions en cours de lecture à l'arrêt sont fermées.
+    void ecouter(int p_ecoute)
+    {
+        vector<ConnexionEnLecture> enLecture;
+        vector<pollfd> attentes;
+        char tampon[4096];
+        while (!arretDemande)
+        {
+            attentes.assign(1, pollfd{p_ecoute, POLLIN, 0});
+            for (const auto &connexion : enLecture) attentes.push_back(pollfd{connexion.descripteur, POLLIN, 0});
+            //le délai de poll() permet de remarquer une demande d'arrêt et les connexions muettes
+            if (poll(attentes.data(), attentes.size(), 200) < 0) continue;
+            auto maintenant = chrono::steady_clock::now();
+
+            size_t nbConservees = 0;
+            for (size_t i = 0; i < enLecture.size(); ++i)
+            {
+                ConnexionEnLecture &connexion = enLecture[i];
+                Connexion prete;
+                int etat = requeteIncomplete;
+                if (attentes[i + 1].revents)
+                {
+                    ssize_t n = recv(connexion.descripteur, tampon, sizeof(tampon), MSG_DONTWAIT);
+                    if (n > 0)
+                    {
+                        connexion.donnees.append(tampon, (size_t) n);
+                        connexion.derniereReception = maintenant;
+                        etat = analyserRequete(connexion.donnees, prete.requete);
+                    }
+                    else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                        etat = connexion.donnees.empty() ? connexionFermee : 400;
+                }
+                else if (maintenant - connexion.derniereReception > chrono::seconds(delaiSecondes))
+                    etat = connexion.donnees.empty() ? connexionFermee : 400;
+
+                if (etat == requeteIncomplete)
+                {
+                    if (nbConservees != i) enLecture[nbConservees] = move(connexion);
+                    ++nbConservees;
+                }
+                else if (etat == connexionFermee) close(connexion.descripteur);
+                else
+                {
+                    prete.descripteur = connexion.descripteur;
+                    prete.acceptation = connexion.acceptation;
+                    prete.lecture = maintenant;
+                    prete.erreur = etat;
+                    m_file.ajouter(move(prete));
+                }
+            }
+            enLecture.resize(nbConservees);
+
+            if (attentes[0].revents & POLLIN)
+            {
+                int client = accept(p_ecoute, nullptr, nullptr);
+                if (client >= 0) enLecture.push_back({client, maintenant, maintenant, string()});
+            }
+            m_metriques.connexionsEnLecture = enLecture.size();
+        }
+        for (const auto &connexion : enLecture) close(connexion.descripteur);
+    }
+
+    //! \brief laisse les travailleurs vider la file, puis les attend
+    void arreter()
+    {
+        m_file.fermer();
+        for (auto &t : m_travailleurs) t.join();
+    }
+
+private:
+    ReseauPartage &m_reseau;
+    SourceGTFS m_source; //relue par /recharger
+    size_t m_tailleLot;
+    FileConnexions m_file;
+    vector<thread> m_travailleurs;
+    Metriques m_metriques;
+
+    void travailler()
+    {
+        vector<Connexion> lot;
+        while (m_file.retirerLot(m_tailleLot, lot))
+        {
+            m_metriques.tailleLot.ajouter(lot.size());
+            //une seule version pour tout le lot: un rechargement ne touche que les lots suivants
+            ReseauPartage::Version version = m_reseau.getVersion();
+            for (const Connexion &connexion : lot)
+            {
+                m_metriques.attente.ajouter(microsecondesDepuis(connexion.lecture));
+                servir(connexion, *version);
+                close(connexion.descripteur);
+            }
+        }
+    }
+
+    void servir(const Connexion &p_connexion, const VersionReseau &p_version)
+    {
+        //un client qui ne lit pas sa réponse ne retient pas le travailleur plus de delaiSecondes
+        timeval delai{delaiSecondes, 0};
+        setsockopt(p_connexion.descripteur, SOL_SOCKET, SO_SNDTIMEO, &delai, sizeof(delai));
+        ReponseHTTP reponse;
+        if (p_connexion.erreur) reponse = reponseErreur(p_connexion.erreur, "requête HTTP invalide");
+        else
+        {
+            try
+            {
+                reponse = router(p_connexion.requete, p_version);
+            }
+            catch (const exception &e)
+            {
+                reponse = reponseErreur(500, e.what());
+            }
+        }
+        envoyerReponse(p_connexion.descripteur, reponse);
+        if (reponse.code < 300) ++m_metriques.reponses2xx;
+        else if (reponse.code < 500) ++m_metriques.reponses4xx;
+        else ++m_metriques.reponses5xx;
+        m_metriques.latence.ajouter(microsecondesDepuis(p_connexion.acceptation));
+    }
+
+    ReponseHTTP router(const RequeteHTTP &p_requete, const VersionReseau &p_version)
+    {
+        const string &m = p_requete.methode;
+        const string &c = p_requete.chemin;
+        if (c == "/itineraire") return m == "GET" ? itineraire(p_requete, p_version) : reponseErreur(405, "GET attendu");
+        if (c == "/itineraires") return m == "POST" ? itineraires(p_requete, p_version) : reponseErreur(405, "POST attendu");
+        if (c == "/metrics") return m == "GET" ? metriques() : reponseErreur(405, "GET attendu");
+        if (c == "/sante") return m == "GET" ? sante(p_version) : reponseErreur(405, "GET attendu");
+        if (c == "/recharger") return m == "POST" ? recharger() : reponseErreur(405, "POST attendu");
+        return reponseErreur(404, "point d'accès inconnu: " + c);
+    }
+
+    //calcule un itinéraire et l'écrit en JSON; une exception de la recherche est une erreur interne (réponse 500),
+    //puisque les données de la requête ont été validées
+    void calculer(const VersionReseau &p_version, const Coordonnees &p_origine, const Coordonnees &p_destination,
+                  const Heure &p_depart, const ParametresRecherche &p_parametres, ostream &p_json)
+    {
+        auto debut = chrono::steady_clock::now();
+        long tempsExecution;
+        Itineraire resultat = p_version.getReseau().calculerItineraire(p_version.getDonnees(), p_origine, p_destination,
+                                                                       p_depart, p_parametres, tempsExecution);
+        m_metriques.recherche.ajouter(microsecondesDepuis(debut));
+        ++m_metriques.itineraires;
+        ecrireJSON(p_json, resultat);
+    }
+
+    ReponseHTTP itineraire(const RequeteHTTP &p_requete, const VersionReseau &p_version)
+    {
+        string origine = parametre(p_requete.parametres, "origine");
+        string destination = parametre(p_requete.parametres, "destination");
+        string depart = parametre(p_requete.parametres, "depart");
+        if (origine.empty() || destination.empty() || depart.empty())
+            return reponseErreur(400, "paramètres origine, destination et depart requis");
+        ReponseHTTP reponse;
+        ostringstream json;
+        try
+        {
+            calculer(p_version, lireCoordonnees(origine), lireCoordonnees(destination), lireDepart(depart, p_version.getDonnees()),
+                     lireParametres(p_requete.parametres), json);
+        }
+        catch (const ErreurRequete &e)
+        {
+            return reponseErreur(400, e.what());
+        }
+        reponse.corps = json.str();
+        return reponse;
+    }
+
+    //une requête par ligne; une ligne invalide donne un objet d'erreur à sa position dans le tableau
+    ReponseHTTP itineraires(const RequeteHTTP &p_requete, const VersionReseau &p_version)
+    {
+        ParametresRecherche parametres; //les mêmes pour toutes les lignes
+        try
+        {
+            parametres = lireParametres(p_requete.parametres);
+        }
+        catch (const ErreurRequete &e)
+        {
+            return reponseErreur(400, e.what());
+        }
+        ostringstream json;
+        json << "[";
+        istringstream corps(p_requete.corps);
+        string ligne;
+        bool premier = true;
+        while (getline(corps, ligne))
+        {
+            if (!ligne.empty() && ligne.back() == '\r') ligne.pop_back();
+            if (ligne.empty()) continue;
+            json << (premier ? "" : ", ");
+            premier = false;
+            vector<string> champs = DonneesGTFS::string_to_vector(ligne, ',');
+            try
+            {
+                if (champs.size() != 5) throw ErreurRequete("ligne attendue: LAT,LON,LAT,LON,HH:MM:SS");
+                calculer(p_version, lireCoordonnees(champs[0], champs[1]), lireCoordonnees(champs[2], champs[3]),
+                         lireDepart(champs[4], p_version.getDonnees()), parametres, json);
+            }
+            catch (const ErreurRequete &e)
+            {
+                json << "{\"erreur\": ";
+                ecrireChaineJSON(json, e.what());
+                json << "}";
+            }
+        }
+        json << "]";
+        ReponseHTTP reponse;
+        reponse.corps = json.str();
+        return reponse;
+    }
+
+    ReponseHTTP metriques()
+    {
+        ostringstream texte;
+        m_metriques.latence.ecrire(texte, "rtc_latence_requete_microsecondes",
+                                   "Durée d'une requête HTTP, de l'acceptation de la connexion à l'envoi de la réponse.");
+        m_metriques.attente.ecrire(texte, "rtc_attente_file_microsecondes",
+                                   "Temps passé par une requête lue dans la file avant qu'un travailleur la prenne.");
+        m_metriques.recherche.ecrire(texte, "rtc_recherche_itineraire_microsecondes",
+                                     "Temps de calcul d'un itinéraire.");
+        m_metriques.tailleLot.ecrire(texte, "rtc_taille_lot", "Nombre de requêtes retirées de la file à la fois.");
+        texte << "# HELP rtc_reponses_total Réponses HTTP envoyées, par classe de code.\n"
+              << "# TYPE rtc_reponses_total counter\n"
+              << "rtc_reponses_total{classe=\"2xx\"} " << m_metriques.reponses2xx << "\n"
+              << "rtc_reponses_total{classe=\"4xx\"} " << m_metriques.reponses4xx << "\n"
+              << "rtc_reponses_total{classe=\"5xx\"} " << m_metriques.reponses5xx << "\n"
+              << "# HELP rtc_itineraires_total Itinéraires calculés.\n# TYPE rtc_itineraires_total counter\n"
+              << "rtc_itineraires_total " << m_metriques.itineraires << "\n"
+              << "# HELP rtc_file_attente Requêtes lues en attente d'un travailleur.\n# TYPE rtc_file_attente gauge\n"
+              << "rtc_file_attente " << m_file.taille() << "\n"
+              << "# HELP rtc_connexions_en_lecture Connexions dont la requête n'est pas encore complète.\n"
+              << "# TYPE rtc_connexions_en_lecture gauge\n"
+              << "rtc_connexions_en_lecture " << m_metriques.connexionsEnLecture << "\n"
+              << "# HELP rtc_publications_reseau_total Versions du réseau publiées.\n"
+              << "# TYPE rtc_publications_reseau_total counter\n"
+              << "rtc_publications_reseau_total " << m_reseau.getNbPublications() << "\n";
+        ReponseHTTP reponse;
+        reponse.type = "text/plain; version=0.0.4";
+        reponse.corps = texte.str();
+        return reponse;
+    }
+
+    ReponseHTTP sante(const VersionReseau &p_version)
+    {
+        ostringstream json;
+        json << "{\"reseau\": " << p_version.getReseau().getIdentifiant()
+             << ", \"publications\": " << m_reseau.getNbPublications()
+             << ", \"rechargementEnCours\": " << (m_reseau.rechargementEnCours() ? "true" : "false")
+             << ", \"derniereErreur\": ";
+        ecrireChaineJSON(json, m_reseau.getDerniereErreur());
+        json << "}";
+        ReponseHTTP reponse;
+        reponse.corps = json.str();
+        return reponse;
+    }
+
+    ReponseHTTP recharger()
+    {
+        if (!m_reseau.rechargerEnArrierePlan(m_source)) return reponseErreur(503, "un rechargement est déjà en cours");
+        ReponseHTTP reponse;
+        reponse.code = 202;
+        reponse.corps = "{\"rechargement\": true}";
+        return reponse;
+    }
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+    SourceGTFS source;
+    string dateTexte = "20180921";
+    string debutTexte = "07:30:00";
+    unsigned int port = 8080;
+    unsigned int nbTravailleurs = 0;
+    size_t tailleLot = 16;
+    //une option invalide est signalée avant le chargement du GTFS: aucune valeur n'est remplacée silencieusement
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            string option = argv[i];
+            if (i + 1 >= argc) throw logic_error("valeur manquante pour " + option);
+            string valeur = argv[++i];
+            if (option == "--gtfs") source.dossier = valeur;
+            else if (option == "--date") dateTexte = valeur;
+            else if (option == "--debut") debutTexte = valeur;
+            else if (option == "--port") port = (unsigned int) lireEntierBorne(option, valeur, 1, 65535);
+            else if (option == "--travailleurs")
+                nbTravailleurs = (unsigned int) lireEntierBorne(option, valeur, 0, travailleursMax);
+            else if (option == "--lot") tailleLot = lireEntierBorne(option, valeur, 1, tailleLotMax);
+            else if (option == "--modele")
+            {
+                if (valeur == "toutesLignes") source.options.modele = ModeleTransferts::TOUTES_LIGNES;
+                else if (valeur == "chainesAttente") source.options.modele = ModeleTransferts::CHAINES_ATTENTE;
+                else throw logic_error("modèle inconnu " + valeur);
+            }
+            else throw logic_error("option inconnue " + option);
+        }
+
+        //comme main(): les arrêts de la journée qui suit l'heure de début
+        source.date = Date::depuisGTFS(dateTexte.data(), dateTexte.data() + dateTexte.size());
+        source.debut = DonneesGTFS::stringToHeure(debutTexte);
+        source.fin = source.debut.add_secondes(86400);
+    }
+    catch (const logic_error &e)
+    {
+        cerr << "ServeurItineraires: " << e.what() << "\n" << usage << endl;
+        return 2;
+    }
+    if (nbTravailleurs == 0) nbTravailleurs = max(1u, thread::hardware_concurrency());
+
+    ReseauPartage reseau;
+    auto debutChargement = chrono::steady_clock::now();
+    reseau.charger(source);
+    cout << "Réseau construit en " << microsecondesDepuis(debutChargement) / 1000 << " ms ("
+         << reseau.getVersion()->getReseau().getNbSommets() << " sommets, "
+         << reseau.getVersion()->getReseau().getNbArcs() << " arcs)" << endl;
+
+    int ecoute = socket(AF_INET, SOCK_STREAM, 0);
+    if (ecoute < 0) throw logic_error("ServeurItineraires: socket() a échoué");
+    int actif = 1;
+    setsockopt(ecoute, SOL_SOCKET, SO_REUSEADDR, &actif, sizeof(actif));
+    sockaddr_in adresse{};
+    adresse.sin_family = AF_INET;
+    adresse.sin_port = htons((uint16_t) port);
+    adresse.sin_addr.s_addr = htonl(INADDR_LOOPBACK); //local seulement
+    if (bind(ecoute, (sockaddr *) &adresse, sizeof(adresse)) != 0 || listen(ecoute, 128) != 0)
+        throw logic_error("ServeurItineraires: impossible d'écouter sur 127.0.0.1:" + to_string(port));
+
+    signal(SIGINT, demanderArret);
+    signal(SIGTERM, demanderArret);
+
+    Serveur serveur(reseau, source, tailleLot);
+    serveur.demarrer(nbTravailleurs);
+    cout << "Écoute sur http://127.0.0.1:" << port << " (" << nbTravailleurs << " travailleurs, lots de " << tailleLot
+         << ")" << endl;
+
+    serveur.ecouter(ecoute);
+    close(ecoute);
+    serveur.arreter();
+    cout << "Arrêt du serveur" << endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# Vérifie qu'une heure de départ hors de l'intervalle des données chargées donne une erreur de requête
+#
+# usage: tester_serveur.sh serveur dossierGTFS [port]
+#
+# Le serveur est démarré sur 127.0.0.1 (avec le début par défaut, 07:30:00), puis:
+#   GET  /itineraire avec depart=06:00:00 doit donner 400 (et non 500);
+#   POST /itineraires avec une ligne valide et une ligne hors intervalle doit donner 200, un itinéraire pour la
+#   première ligne et un objet {"erreur": ...} pour la seconde.
+# Nécessite curl.
+#
+
+serveur=$1
+gtfs=$2
+port=${3:-18080}
+url="http://127.0.0.1:$port"
+
+if [ -z "$serveur" ] || [ -z "$gtfs" ]; then
+    echo "usage: tester_serveur.sh serveur dossierGTFS [port]" >&2
+    exit 2
+fi
+
+sortie=$(mktemp)
+"$serveur" --gtfs "$gtfs" --port "$port" --travailleurs 2 > /dev/null 2>&1 &
+pid=$!
+trap 'kill $pid 2> /dev/null; wait $pid 2> /dev/null; rm -f "$sortie"' EXIT
+
+#le chargement du GTFS prend quelques secondes
+essais=0
+until curl -s -o /dev/null "$url/sante"; do
+    essais=$((essais + 1))
+    if [ $essais -ge 120 ] || ! kill -0 $pid 2> /dev/null; then
+        echo "ÉCHEC: le serveur n'a pas démarré" >&2
+        exit 1
+    fi
+    sleep 1
+done
+
+echec=0
+
+code=$(curl -s -o "$sortie" -w '%{http_code}' \
+    "$url/itineraire?origine=46.778808,-71.270014&destination=46.812173,-71.217698&depart=06:00:00")
+if [ "$code" != "400" ]; then
+    echo "ÉCHEC: GET hors intervalle: $code (400 attendu): $(cat "$sortie")" >&2
+    echec=1
+fi
+
+code=$(curl -s -o "$sortie" -w '%{http_code}' --data-binary \
+    "$(printf '46.778808,-71.270014,46.812173,-71.217698,08:00:00\n46.778808,-71.270014,46.812173,-71.217698,06:00:00')" \
+    "$url/itineraires")
+if [ "$code" != "200" ]; then
+    echo "ÉCHEC: POST avec une ligne hors intervalle: $code (200 attendu): $(cat "$sortie")" >&2
+    echec=1
+elif [ "$(grep -o '"erreur"' "$sortie" | wc -l)" -ne 1 ]; then
+    echo "ÉCHEC: POST avec une ligne hors intervalle: une seule erreur attendue: $(cat "$sortie")" >&2
+    echec=1
+fi
+
+if [ $echec -eq 0 ]; then echo "Succès"; fi
+exit $echec